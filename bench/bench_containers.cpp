@@ -0,0 +1,149 @@
+/*
+ * bench_containers.cpp
+ *
+ *  容器的单线程微基准: 每轮压入batch个元素再全部取出.
+ *      队列(FIFO): struct deque(带检查、_fast、批量)、ctl::static_deque、std::deque;
+ *      栈(LIFO):   struct stack、ctl::static_stack、std::vector、std::deque.
+ *  struct deque/stack按编译选项选择STATIC或DYNAMIC模式，STATIC时batch不超过4096.
+ *
+ *  编译(主机):
+ *      gcc -O2 -I../deque -I../stack -I../pool -c bench_containers_c.c
+ *      g++ -O2 -I../deque -I../stack -o bench_containers bench_containers.cpp \
+ *          bench_containers_c.o ../deque/deque.c ../stack/stack.c ../pool/pool.c
+ *  (deque.c等按C编译，见Makefile)
+ *
+ *  用法: ./bench_containers [轮数] [每轮的元素个数]
+ */
+
+#include "deque.hpp"
+#include "stack.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+extern "C" {
+extern volatile long long c_sink;
+double c_deque_fifo(int rounds, int batch, int mode);
+double c_stack_lifo(int rounds, int batch);
+}
+
+static volatile long long sink;
+
+/* 每个元素的平均耗时(ns) */
+template <class F>
+static double per_elem(int rounds, int batch, F body)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        body();
+    std::chrono::duration<double, std::nano> t = std::chrono::steady_clock::now() - t0;
+
+    return t.count() / (static_cast<double>(rounds) * batch);
+}
+
+static void report(const char *name, double ns)
+{
+    if (ns < 0)
+        std::printf("%-28s init failed\n", name);
+    else
+        std::printf("%-28s %8.2f ns/elem %9.1f Melem/s\n", name, ns, 1e3 / ns);
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int batch = argc > 2 ? std::atoi(argv[2]) : 4096;
+
+    if (batch > 4096) {
+        std::printf("batch is limited to 4096 by the static containers.\n");
+        batch = 4096;
+    }
+
+    std::printf("%d rounds x %d elements\n\nFIFO\n", rounds, batch);
+
+    report("struct deque", c_deque_fifo(rounds, batch, 0));
+    report("struct deque _fast", c_deque_fifo(rounds, batch, 1));
+    report("struct deque _n", c_deque_fifo(rounds, batch, 2));
+
+    {
+        static ctl::static_deque<int, 4096> q;
+        report("ctl::static_deque", per_elem(rounds, batch, [&] {
+            long long s = 0;
+            for (int i = 0; i < batch; ++i)
+                q.push_back(i);
+            for (int i = 0; i < batch; ++i) {
+                s += q.front();
+                q.pop_front();
+            }
+            sink += s;
+        }));
+    }
+
+    {
+        std::deque<int> q;
+        report("std::deque", per_elem(rounds, batch, [&] {
+            long long s = 0;
+            for (int i = 0; i < batch; ++i)
+                q.push_back(i);
+            for (int i = 0; i < batch; ++i) {
+                s += q.front();
+                q.pop_front();
+            }
+            sink += s;
+        }));
+    }
+
+    std::printf("\nLIFO\n");
+
+    report("struct stack", c_stack_lifo(rounds, batch));
+
+    {
+        static ctl::static_stack<int, 4096> st;
+        report("ctl::static_stack", per_elem(rounds, batch, [&] {
+            long long s = 0;
+            for (int i = 0; i < batch; ++i)
+                st.push(i);
+            for (int i = 0; i < batch; ++i) {
+                s += st.top();
+                st.pop();
+            }
+            sink += s;
+        }));
+    }
+
+    {
+        std::vector<int> v;
+        report("std::vector", per_elem(rounds, batch, [&] {
+            long long s = 0;
+            for (int i = 0; i < batch; ++i)
+                v.push_back(i);
+            for (int i = 0; i < batch; ++i) {
+                s += v.back();
+                v.pop_back();
+            }
+            sink += s;
+        }));
+    }
+
+    {
+        std::deque<int> d;
+        report("std::deque (stack)", per_elem(rounds, batch, [&] {
+            long long s = 0;
+            for (int i = 0; i < batch; ++i)
+                d.push_back(i);
+            for (int i = 0; i < batch; ++i) {
+                s += d.back();
+                d.pop_back();
+            }
+            sink += s;
+        }));
+    }
+
+    /* 输出累加值，防止循环被优化掉 */
+    std::printf("\nchecksum %lld %lld\n", static_cast<long long>(c_sink),
+            static_cast<long long>(sink));
+
+    return 0;
+}
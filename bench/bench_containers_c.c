@@ -0,0 +1,108 @@
+/*
+ * bench_containers_c.c
+ *
+ *  bench_containers的C部分: struct deque与struct stack的计时循环.
+ *  按C编译，计时的是C调用者实际得到的代码(含POOL_ATOMIC为1时的原子位图).
+ */
+
+#include "deque.h"
+#include "stack.h"
+#include <time.h>
+
+/* 累加取出的元素，防止循环被优化掉 */
+volatile long long c_sink;
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/*
+ * 每轮从队尾压入batch个，再从队头全部取出，共rounds轮.
+ * mode: 0 带检查的push_back/pop_front; 1 不检查的_fast; 2 push_back_n/pop_front_n.
+ * 返回每个元素(压入加取出)的平均耗时(ns)，初始化失败时返回-1.
+ */
+double c_deque_fifo(int rounds, int batch, int mode)
+{
+    static qdata buf[4096];
+    struct deque q;
+    long long sum = 0;
+    double t0;
+    int r, i, j, k;
+    qdata v;
+
+    if (deque_init(&q) < 0)
+        return -1;
+
+    for (i = 0; i < 4096; ++i)
+        buf[i] = i;
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; ++r) {
+        switch (mode) {
+        case 0:
+            for (i = 0; i < batch; ++i)
+                deque_push_back(&q, i);
+            for (i = 0; i < batch; ++i) {
+                deque_pop_front(&q, &v);
+                sum += v;
+            }
+            break;
+        case 1:
+            for (i = 0; i < batch; ++i)
+                deque_push_back_fast(&q, i);
+            for (i = 0; i < batch; ++i)
+                sum += deque_pop_front_fast(&q);
+            break;
+        default:
+            for (i = 0; i < batch; i += k) {
+                k = batch - i < 4096 ? batch - i : 4096;
+                deque_push_back_n(&q, buf, k);
+            }
+            for (i = 0; i < batch; i += k) {
+                k = deque_pop_front_n(&q, buf, batch - i < 4096 ? batch - i : 4096);
+                for (j = 0; j < k; ++j)
+                    sum += buf[j];
+            }
+            break;
+        }
+    }
+    t0 = now_ns() - t0;
+
+    c_sink += sum;
+    deque_destroy(&q);
+
+    return t0 / ((double)rounds * batch);
+}
+
+/* 每轮压入batch个再全部弹出，返回每个元素的平均耗时(ns) */
+double c_stack_lifo(int rounds, int batch)
+{
+    struct stack st;
+    long long sum = 0;
+    double t0;
+    int r, i;
+    ST_data_type v;
+
+    if (stack_init(&st) < 0)
+        return -1;
+
+    t0 = now_ns();
+    for (r = 0; r < rounds; ++r) {
+        for (i = 0; i < batch; ++i)
+            stack_push(&st, i);
+        for (i = 0; i < batch; ++i) {
+            stack_pop(&st, &v);
+            sum += v;
+        }
+    }
+    t0 = now_ns() - t0;
+
+    c_sink += sum;
+    destroy_stack(&st);
+
+    return t0 / ((double)rounds * batch);
+}
@@ -0,0 +1,146 @@
+/*
+ * bench_dbscan.c
+ *
+ *  dbscan()在不同点数n、半径e、minpts下的吞吐量与单帧延迟分布.
+ *  每组参数用FRAMES个不同种子的合成帧(pdw_gen)，每帧计时reset_dbscan() + get_data()
+ *  (+ dbscan_dedup()) + dbscan()，输出点数/秒与延迟的p50/p90/p99/最大值.
+ *  编译时定义DBSCAN_PROF=1时另外输出搜索与扩展所占的比例.
+ *
+ *  编译(主机):
+ *      gcc -O2 -Ihost -I../signal_proc/dbscan -I../deque -I../stack -I../pool \
+ *          -o bench_dbscan bench_dbscan.c pdw_gen.c \
+ *          ../signal_proc/dbscan/dbscan.c ../signal_proc/dbscan/nbr_index.c \
+ *          ../signal_proc/dbscan/nbr_kernel.c ../deque/deque.c ../pool/pool.c
+ *  或make bench_dbscan DEFS="-DNBR_SEARCH_MEASURE=3 ..."
+ *
+ *  用法: ./bench_dbscan [每组的帧数] [噪声比例] [重复比例]
+ */
+
+#include "dbscan.h"
+#include "pdw_gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_N (4096)
+
+static const int ns[] = { 512, 1024, 2048, 4096 };
+static const unsigned int es[] = { 1u << 19, 1u << 20, 1u << 21 };
+static const unsigned int minpts[] = { 4, 8, 16 };
+
+#define COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static double now_us(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* 已排序的v中第p百分位 */
+static double percentile(const double *v, int n, double p)
+{
+	int k = (int)(p / 100.0 * (n - 1) + 0.5);
+
+	return v[k];
+}
+
+int main(int argc, char *argv[])
+{
+	struct pdw_gen_cfg cfg = PDW_GEN_DEFAULT;
+	ORIG_PDW *frames;
+	double *lat;
+	int nframe = argc > 1 ? atoi(argv[1]) : 50;
+	dbscan_st db;
+	double t0, sum;
+	int a, b, c, f, groups;
+#if DBSCAN_PROF
+	struct dbscan_prof prof;
+	double search, expand;
+#endif
+
+	if (nframe < 1)
+		nframe = 50;
+	if (argc > 2)
+		cfg.noise = atof(argv[2]);
+	if (argc > 3)
+		cfg.repeat = atof(argv[3]);
+
+	frames = (ORIG_PDW *)malloc(sizeof(ORIG_PDW) * MAX_N * nframe);
+	lat = (double *)malloc(sizeof(double) * nframe);
+	if (!frames || !lat || init_dbscan(&db, MAX_N) < 0)
+		return 1;
+
+	printf("%d frames per row, %d emitters, noise %.2f, repeat %.2f\n",
+			nframe, cfg.nemitter, cfg.noise, cfg.repeat);
+	printf("%6s %7s %6s %6s %10s %9s %9s %9s %9s",
+			"n", "e(deg)", "minpts", "groups", "Mpts/s", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+#if DBSCAN_PROF
+	printf(" %7s %7s", "search", "expand");
+#endif
+	printf("\n");
+
+	for (a = 0; a < COUNT(ns); ++a) {
+		cfg.n = ns[a];
+		for (f = 0; f < nframe; ++f) {
+			cfg.seed = 20240901 + f;
+			pdw_gen(&cfg, frames + (size_t)f * MAX_N);
+		}
+
+		for (b = 0; b < COUNT(es); ++b) {
+			for (c = 0; c < COUNT(minpts); ++c) {
+				sum = 0;
+				groups = 0;
+#if DBSCAN_PROF
+				search = expand = 0;
+#endif
+
+				for (f = 0; f < nframe; ++f) {
+					t0 = now_us();
+					reset_dbscan(&db, cfg.n);
+					get_data(&db, frames + (size_t)f * MAX_N);
+#if DBSCAN_DEDUP
+					dbscan_dedup(&db, 0);
+#endif
+					dbscan(&db, es[b], minpts[c]);
+					lat[f] = now_us() - t0;
+
+					sum += lat[f];
+					groups += db.ngroup;
+#if DBSCAN_PROF
+					dbscan_get_prof(&db, &prof);
+					search += prof.search;
+					expand += prof.expand;
+#endif
+				}
+
+				qsort(lat, nframe, sizeof(lat[0]), cmp_double);
+
+				printf("%6d %7.2f %6u %6d %10.2f %9.1f %9.1f %9.1f %9.1f",
+						cfg.n, es[b] / (double)(1u << 20), minpts[c], groups / nframe,
+						cfg.n * nframe / sum, percentile(lat, nframe, 50),
+						percentile(lat, nframe, 90), percentile(lat, nframe, 99),
+						lat[nframe - 1]);
+#if DBSCAN_PROF
+				printf(" %6.1f%% %6.1f%%", 100 * search / (search + expand),
+						100 * expand / (search + expand));
+#endif
+				printf("\n");
+			}
+		}
+	}
+
+	del_dbscan(&db);
+	free(frames);
+	free(lat);
+
+	return 0;
+}
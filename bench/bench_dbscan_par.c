@@ -0,0 +1,86 @@
+/*
+ * bench_dbscan_par.c
+ *
+ *  dbscan_par()随线程数的加速比，并与dbscan()的结果逐点比对.
+ *
+ *  编译(主机):
+ *      gcc -O2 -pthread -Ihost -I../signal_proc/dbscan -I../deque -I../stack -I../pool \
+ *          -o bench_dbscan_par bench_dbscan_par.c pdw_gen.c ../signal_proc/dbscan/dbscan.c \
+ *          ../signal_proc/dbscan/dbscan_par.c ../signal_proc/dbscan/nbr_index.c \
+ *          ../signal_proc/dbscan/nbr_kernel.c ../deque/deque.c ../pool/pool.c \
+ *          ../deque/ws_deque.c
+ *  加-DDBSCAN_PAR_MEASURE=2测试工作窃取扩展.
+ *
+ *  用法: ./bench_dbscan_par [最大线程数] [帧数]
+ */
+
+#include "dbscan_par.h"
+#include "pdw_gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NUM (4096)
+
+static double now_ms(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+	static ORIG_PDW src[NUM];
+	static dbscan_label_t ref[NUM];
+	struct pdw_gen_cfg cfg = PDW_GEN_DEFAULT;
+	unsigned int e = 1u << 19, minpts = 8;
+	int max_threads = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	int frames = argc > 2 ? atoi(argv[2]) : 20;
+	dbscan_st db;
+	dbscan_par_st par;
+	double t0, base;
+	int f, t, i, diff;
+
+	/* 16个辐射源加10%的随机噪声 */
+	cfg.n = NUM;
+	pdw_gen(&cfg, src);
+
+	init_dbscan(&db, NUM);
+
+	t0 = now_ms();
+	for (f = 0; f < frames; ++f) {
+		reset_dbscan(&db, NUM);
+		get_data(&db, src);
+		dbscan(&db, e, minpts);
+	}
+	base = (now_ms() - t0) / frames;
+	memcpy(ref, db.major, sizeof(ref));
+	printf("dbscan:      %8.3f ms/frame  %d groups\n", base, db.ngroup);
+
+	for (t = 1; t <= max_threads; t *= 2) {
+		if (init_dbscan_par(&par, t, NUM) < 0)
+			break;
+
+		t0 = now_ms();
+		for (f = 0; f < frames; ++f)
+			dbscan_par(&par, &db, e, minpts);
+		t0 = (now_ms() - t0) / frames;
+
+		diff = 0;
+		for (i = 0; i < NUM; ++i)
+			diff += db.major[i] != ref[i];
+
+		printf("threads %3d: %8.3f ms/frame  x%.2f  %d groups  %d mismatched\n",
+				t, t0, base / t0, db.ngroup, diff);
+
+		del_dbscan_par(&par);
+	}
+
+	del_dbscan(&db);
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * bench_lf_stack.c
+ *
+ *  把lf_stack当作帧缓冲区的空闲链表: 预先压入BUFS个缓冲区编号，
+ *  每个线程反复取出若干个再放回，线程数从1增加到最大线程数，
+ *  比较lf_stack(逐个、整串压入)与加互斥锁的struct stack，最后检查编号没有丢失或重复.
+ *
+ *  编译(主机):
+ *      gcc -O2 -pthread -I../stack -I../pool -o bench_lf_stack bench_lf_stack.c \
+ *          ../stack/lf_stack.c ../stack/stack.c ../pool/pool.c
+ *
+ *  用法: ./bench_lf_stack [最大线程数] [每个线程的操作次数]
+ */
+
+#include "lf_stack.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BUFS (256)
+#define HOLD (4)				/* 每次取出的缓冲区个数 */
+#define MAX_THREADS (64)
+
+enum { LF_ONE, LF_CHAIN, MUTEX_ONE };
+
+static const char *mode_name[] = {
+	"lf_stack",
+	"lf_stack chain",
+	"mutex + stack",
+};
+
+static int mode;
+static int ops;
+static struct lf_stack lf;
+static struct stack ms;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now_s(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int get(int *to)
+{
+	int ret;
+
+	if (mode != MUTEX_ONE)
+		return lf_stack_pop(&lf, to);
+
+	pthread_mutex_lock(&lock);
+	ret = ms.capacity ? stack_pop(&ms, to) : -1;
+	pthread_mutex_unlock(&lock);
+
+	return ret;
+}
+
+static void put(const int *src, int n)
+{
+	int k;
+
+	if (mode == LF_CHAIN) {
+		lf_stack_push_n(&lf, src, n);
+		return;
+	}
+
+	for (k = 0; k < n; ++k) {
+		if (mode == LF_ONE) {
+			lf_stack_push(&lf, src[k]);
+		} else {
+			pthread_mutex_lock(&lock);
+			stack_push(&ms, src[k]);
+			pthread_mutex_unlock(&lock);
+		}
+	}
+}
+
+static void *worker(void *arg)
+{
+	int buf[HOLD];
+	int i, n;
+
+	(void)arg;
+
+	for (i = 0; i < ops; ++i) {
+		for (n = 0; n < HOLD && get(&buf[n]) == 0; ++n)
+			;
+		put(buf, n);
+	}
+
+	return NULL;
+}
+
+/* 取出全部编号，检查每个编号恰好出现一次 */
+static int check(void)
+{
+	static int seen[BUFS];
+	int v, n = 0, bad = 0;
+
+	memset(seen, 0, sizeof(seen));
+	while (get(&v) == 0) {
+		if (v < 0 || v >= BUFS || seen[v]++)
+			++bad;
+		++n;
+	}
+
+	return bad + (n != BUFS);
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t th[MAX_THREADS];
+	int max_threads = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	int t, i;
+	double t0;
+
+	ops = argc > 2 ? atoi(argv[2]) : 1000000;
+	if (max_threads > MAX_THREADS)
+		max_threads = MAX_THREADS;
+
+	lf_stack_init(&lf);
+	stack_init(&ms);
+
+	for (mode = LF_ONE; mode <= MUTEX_ONE; ++mode) {
+		for (t = 1; t <= max_threads; t *= 2) {
+			for (i = 0; i < BUFS; ++i)
+				put(&i, 1);
+
+			t0 = now_s();
+			for (i = 0; i < t; ++i) {
+				if (pthread_create(&th[i], NULL, worker, NULL) != 0) {
+					printf("create thread %d failed.\n", i);
+					exit(1);
+				}
+			}
+			for (i = 0; i < t; ++i)
+				pthread_join(th[i], NULL);
+			t0 = now_s() - t0;
+
+			printf("%-16s %2d threads %8.2f Mops/s  %s\n", mode_name[mode], t,
+					2.0 * HOLD * t * ops / t0 / 1e6, check() ? "LOST" : "ok");
+		}
+	}
+
+	lf_stack_destroy(&lf);
+	destroy_stack(&ms);
+
+	return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * bench_mpmc.c
+ *
+ *  P个生产者、P个消费者经同一个队列传递整数，P从1增加到最大线程数，
+ *  比较mpmc_deque(逐个、批量)与加互斥锁的struct deque在竞争下的吞吐量.
+ *  元素为(生产者编号 << 24) | 序号，消费者检查每个生产者的元素是否按顺序到达.
+ *
+ *  编译(主机):
+ *      gcc -O2 -pthread -I../deque -I../pool -o bench_mpmc bench_mpmc.c \
+ *          ../deque/mpmc_deque.c ../deque/deque.c ../pool/pool.c
+ *
+ *  用法: ./bench_mpmc [最大线程数] [每个生产者的元素个数]
+ */
+
+#include "mpmc_deque.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH (64)
+#define MAX_THREADS (64)
+
+enum { MPMC_ONE, MPMC_BATCH, MUTEX_ONE };
+
+static const char *mode_name[] = {
+    "mpmc_deque",
+    "mpmc_deque batch",
+    "mutex + deque",
+};
+
+static int mode;
+static int per;                 /* 每个生产者的元素个数 */
+static atomic_int remain;       /* 尚未取出的元素个数 */
+static atomic_llong errors;
+static struct mpmc_deque q;
+static struct deque mq;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now_s(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int mutex_push(int d)
+{
+    int ret = -2;
+
+    pthread_mutex_lock(&lock);
+    if (deque_size(&mq) < 4096)
+        ret = deque_push_back(&mq, d);
+    pthread_mutex_unlock(&lock);
+
+    return ret;
+}
+
+static int mutex_pop(int *to)
+{
+    int ret = -2;
+
+    pthread_mutex_lock(&lock);
+    if (!deque_empty(&mq))
+        ret = deque_pop_front(&mq, to);
+    pthread_mutex_unlock(&lock);
+
+    return ret;
+}
+
+static void *producer(void *arg)
+{
+    int id = (int)(long)arg;
+    int buf[BATCH];
+    int i = 0, k, n, done;
+
+    while (i < per) {
+        if (mode == MPMC_BATCH) {
+            n = per - i < BATCH ? per - i : BATCH;
+            for (k = 0; k < n; ++k)
+                buf[k] = (id << 24) | (i + k);
+            done = mpmc_deque_push_back_n(&q, buf, n);
+        } else if (mode == MPMC_ONE) {
+            done = mpmc_deque_try_push_back(&q, (id << 24) | i) == 0;
+        } else {
+            done = mutex_push((id << 24) | i) == 0;
+        }
+
+        if (done == 0)
+            sched_yield();
+        i += done;
+    }
+
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    int last[MAX_THREADS];
+    int buf[BATCH];
+    int k, done, id;
+    long long err = 0;
+
+    (void)arg;
+
+    for (k = 0; k < MAX_THREADS; ++k)
+        last[k] = -1;
+
+    while (atomic_load_explicit(&remain, memory_order_relaxed) > 0) {
+        if (mode == MPMC_BATCH)
+            done = mpmc_deque_pop_front_n(&q, buf, BATCH);
+        else if (mode == MPMC_ONE)
+            done = mpmc_deque_try_pop_front(&q, buf) == 0;
+        else
+            done = mutex_pop(buf) == 0;
+
+        if (done == 0) {
+            sched_yield();
+            continue;
+        }
+
+        /* 同一生产者的元素，序号应递增 */
+        for (k = 0; k < done; ++k) {
+            id = buf[k] >> 24;
+            err += (buf[k] & 0xffffff) <= last[id];
+            last[id] = buf[k] & 0xffffff;
+        }
+        atomic_fetch_sub_explicit(&remain, done, memory_order_relaxed);
+    }
+
+    atomic_fetch_add(&errors, err);
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t th[2 * MAX_THREADS];
+    int max_threads = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int p, i;
+    double t0;
+
+    per = argc > 2 ? atoi(argv[2]) : 1000000;
+    if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+    if (per > 0xffffff)
+        per = 0xffffff;
+
+    mpmc_deque_init(&q);
+    deque_init(&mq);
+
+    for (mode = MPMC_ONE; mode <= MUTEX_ONE; ++mode) {
+        for (p = 1; p <= max_threads; p *= 2) {
+            atomic_store(&remain, p * per);
+            atomic_store(&errors, 0);
+
+            t0 = now_s();
+            for (i = 0; i < p; ++i) {
+                /* 少一个线程时其余线程等不到remain为0，直接退出进程 */
+                if (pthread_create(&th[i], NULL, producer, (void *)(long)i) != 0
+                        || pthread_create(&th[p + i], NULL, consumer, NULL) != 0) {
+                    printf("create thread failed.\n");
+                    exit(1);
+                }
+            }
+            for (i = 0; i < 2 * p; ++i)
+                pthread_join(th[i], NULL);
+            t0 = now_s() - t0;
+
+            printf("%-18s %2d x %-2d %8.2f Mops/s  %lld out of order  %d left\n",
+                    mode_name[mode], p, p, (double)p * per / t0 / 1e6,
+                    (long long)atomic_load(&errors), mpmc_deque_size(&q) + deque_size(&mq));
+        }
+    }
+
+    mpmc_deque_destroy(&q);
+    deque_destroy(&mq);
+
+    return 0;
+}
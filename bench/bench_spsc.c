@@ -0,0 +1,169 @@
+/*
+ * bench_spsc.c
+ *
+ *  一个生产者线程、一个消费者线程传递整数，
+ *  比较spsc_deque(逐个、批量)与加互斥锁的struct deque的吞吐量.
+ *
+ *  编译(主机):
+ *      gcc -O2 -pthread -I../deque -I../pool -o bench_spsc bench_spsc.c \
+ *          ../deque/spsc_deque.c ../deque/deque.c ../pool/pool.c
+ *
+ *  用法: ./bench_spsc [元素个数]
+ */
+
+#include "spsc_deque.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BATCH (64)
+
+enum { SPSC_ONE, SPSC_BATCH, MUTEX_ONE, MUTEX_BATCH };
+
+static const char *mode_name[] = {
+    "spsc_deque",
+    "spsc_deque batch",
+    "mutex + deque",
+    "mutex + deque batch",
+};
+
+static int mode;
+static int total;
+static struct spsc_deque sq;
+static struct deque mq;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static double now_s(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* 加锁放入最多n个，返回放入的个数 */
+static int mutex_push(const int *src, int n)
+{
+    int k;
+
+    pthread_mutex_lock(&lock);
+    for (k = 0; k < n && deque_size(&mq) < 4096; ++k)
+        deque_push_back(&mq, src[k]);
+    pthread_mutex_unlock(&lock);
+
+    return k;
+}
+
+static int mutex_pop(int *to, int n)
+{
+    int k;
+
+    pthread_mutex_lock(&lock);
+    for (k = 0; k < n && !deque_empty(&mq); ++k)
+        deque_pop_front(&mq, &to[k]);
+    pthread_mutex_unlock(&lock);
+
+    return k;
+}
+
+static void *producer(void *arg)
+{
+    int buf[BATCH];
+    int i = 0, k, n, done;
+
+    (void)arg;
+
+    while (i < total) {
+        n = total - i < BATCH ? total - i : BATCH;
+        for (k = 0; k < n; ++k)
+            buf[k] = i + k;
+
+        if (mode == SPSC_ONE || mode == MUTEX_ONE)
+            n = 1;
+
+        switch (mode) {
+        case SPSC_ONE:
+            done = spsc_deque_push_back(&sq, buf[0]) == 0;
+            break;
+        case SPSC_BATCH:
+            done = spsc_deque_push_back_n(&sq, buf, n);
+            break;
+        default:
+            done = mutex_push(buf, n);
+            break;
+        }
+
+        if (done == 0)
+            sched_yield();
+        i += done;
+    }
+
+    return NULL;
+}
+
+static long long consume(void)
+{
+    int buf[BATCH];
+    int i = 0, k, done;
+    long long errors = 0;
+
+    while (i < total) {
+        switch (mode) {
+        case SPSC_ONE:
+            done = spsc_deque_pop_front(&sq, buf) == 0;
+            break;
+        case SPSC_BATCH:
+            done = spsc_deque_pop_front_n(&sq, buf, BATCH);
+            break;
+        case MUTEX_ONE:
+            done = mutex_pop(buf, 1);
+            break;
+        default:
+            done = mutex_pop(buf, BATCH);
+            break;
+        }
+
+        if (done == 0)
+            sched_yield();
+
+        /* 检查顺序 */
+        for (k = 0; k < done; ++k)
+            errors += buf[k] != i + k;
+        i += done;
+    }
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t th;
+    long long errors;
+    double t0;
+
+    total = argc > 1 ? atoi(argv[1]) : 20000000;
+
+    spsc_deque_init(&sq);
+    deque_init(&mq);
+
+    for (mode = SPSC_ONE; mode <= MUTEX_BATCH; ++mode) {
+        t0 = now_s();
+        if (pthread_create(&th, NULL, producer, NULL) != 0) {
+            printf("create producer thread failed.\n");
+            return 1;
+        }
+        errors = consume();
+        pthread_join(th, NULL);
+        t0 = now_s() - t0;
+
+        printf("%-22s %8.2f Mops/s  %lld out of order\n",
+                mode_name[mode], total / t0 / 1e6, errors);
+    }
+
+    spsc_deque_destroy(&sq);
+    deque_destroy(&mq);
+
+    return 0;
+}
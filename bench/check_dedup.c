@@ -0,0 +1,189 @@
+/*
+ * check_dedup.c
+ *
+ *  对比dbscan_dedup() + dbscan()与不合并时对原始点调用dbscan()的结果:
+ *      完全相同的点(q为0): pdw_gen生成带重复脉冲的帧，各点的类编号应完全相同;
+ *      量化后相同的点(q不为0): 各点取在几个小团中，同一团的点落在同一个量化格中，
+ *      团之间的距离离e足够远，量化不改变e领域，各点的类编号也应完全相同.
+ *  同时检查dbscan()结束后各点的PDW回到原来的顺序，点数恢复为原始点数;
+ *  一半的帧用attach_data()，检查外部的set也恢复原样.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=address,undefined -DDBSCAN_DEDUP=1 -Ihost \
+ *          -I../signal_proc/dbscan -I../deque -I../stack -I../pool -o check_dedup \
+ *          check_dedup.c pdw_gen.c ../signal_proc/dbscan/dbscan.c \
+ *          ../signal_proc/dbscan/nbr_index.c ../signal_proc/dbscan/nbr_kernel.c \
+ *          ../deque/deque.c ../pool/pool.c
+ *  或make check
+ *
+ *  用法: ./check_dedup [帧数] [随机种子]
+ */
+
+#include "dbscan.h"
+#include "pdw_gen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !DBSCAN_DEDUP
+#error "check_dedup needs DBSCAN_DEDUP=1"
+#endif
+
+#define MAX_N  (4096)
+#define E      (1u << 20)
+#define Q      (1u << 16)		/* 量化步长，远小于E */
+#define NBLOB  (160)
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			printf("frame %d (%s): %s failed\n", frame, name, #cond); \
+			exit(1); \
+		} \
+	} while (0)
+
+static dbscan_st raw, dd;
+static ORIG_PDW src[MAX_N];
+static pdw_st set[MAX_N], copy[MAX_N];
+static const char *name;
+static unsigned int rng;
+static int frame;
+
+static unsigned int rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+/* 对src中的n个点分别不合并与合并后聚类，比较结果 */
+static int compare(int n, unsigned int q, unsigned int minpts, int attach)
+{
+	int i, nu;
+
+	CHECK(reset_dbscan(&raw, n) == 0);
+	get_data(&raw, src);
+	dbscan(&raw, E, minpts);
+
+	CHECK(reset_dbscan(&dd, n) == 0);
+	if (attach) {
+		for (i = 0; i < n; ++i) {
+			set[i].aoa = src[i].AOA;
+			set[i].freq = src[i].FC;
+			set[i].pw = src[i].PW;
+		}
+		memcpy(copy, set, sizeof(set[0]) * n);
+		attach_data(&dd, set);
+	} else {
+		get_data(&dd, src);
+	}
+
+	nu = dbscan_dedup(&dd, q);
+	CHECK(nu > 0 && nu <= n);
+	dbscan(&dd, E, minpts);
+
+	CHECK((int)dd.capacity == n);
+	CHECK(dd.ngroup == raw.ngroup);
+	for (i = 0; i < n; ++i) {
+		CHECK(dd.major[i] == raw.major[i]);
+		CHECK(PDW_AOA(&dd, i) == src[i].AOA);
+		CHECK(PDW_PW(&dd, i) == src[i].PW);
+		CHECK(PDW_FREQ(&dd, i) == src[i].FC);
+	}
+	if (attach)
+		CHECK(memcmp(copy, set, sizeof(set[0]) * n) == 0);
+
+	return nu;
+}
+
+/* pdw_gen的帧，一部分脉冲与同一辐射源的上一个脉冲完全相同 */
+static void check_exact(int nframe)
+{
+	struct pdw_gen_cfg cfg = PDW_GEN_DEFAULT;
+	long n = 0, nu = 0;
+
+	name = "exact";
+	for (frame = 0; frame < nframe; ++frame) {
+		cfg.n = 256 + rnd() % (MAX_N - 255);
+		cfg.nemitter = 1 + rnd() % 32;
+		cfg.repeat = (rnd() % 90) / 100.0;
+		cfg.noise = (rnd() % 30) / 100.0;
+		cfg.seed = rnd();
+		pdw_gen(&cfg, src);
+
+		nu += compare(cfg.n, 0, 2 + rnd() % 15, frame & 1);
+		n += cfg.n;
+	}
+
+	printf("check_dedup %s: %d frames ok, %ld points merged into %ld\n", name, nframe, n, nu);
+}
+
+/*
+ * 团的中心在aoa方向上排成一列，间距0.6e(相连)或1.5e(断开)，
+ * 团内各点在中心所在的量化格内，与中心的差值小于Q; 团的大小为1~8，
+ * 小于minpts的团为边界点或噪声. 距离与e至少差Q，量化前后e领域相同.
+ */
+static int gen_blobs(void)
+{
+	unsigned int a = 10u << 20, pw = 10u << 20;
+	int b, k, m, n = 0;
+	ORIG_PDW t;
+
+	for (b = 0; b < NBLOB && n + 8 <= MAX_N; ++b) {
+		a += rnd() & 1 ? E / 10 * 6 : E / 2 * 3;
+		a -= a % Q;
+
+		for (k = 0, m = 1 + rnd() % 8; k < m; ++k) {
+			src[n].AOA = a + rnd() % Q;
+			src[n].PW = pw + rnd() % Q;
+			src[n].FC = (1000u << 20) + rnd() % Q;
+			++n;
+		}
+	}
+
+	/* 打乱顺序，同一团的点不连续 */
+	for (k = n - 1; k > 0; --k) {
+		m = rnd() % (k + 1);
+		t = src[k];
+		src[k] = src[m];
+		src[m] = t;
+	}
+
+	return n;
+}
+
+static void check_quantized(int nframe)
+{
+	long n = 0, nu = 0;
+	int m;
+
+	name = "quantized";
+	for (frame = 0; frame < nframe; ++frame) {
+		m = gen_blobs();
+		nu += compare(m, Q, 2 + rnd() % 10, frame & 1);
+		n += m;
+	}
+
+	printf("check_dedup %s: %d frames ok, %ld points merged into %ld\n", name, nframe, n, nu);
+}
+
+int main(int argc, char *argv[])
+{
+	int nframe = argc > 1 ? atoi(argv[1]) : 200;
+
+	rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20240902;
+	if (!rng)
+		rng = 1;
+
+	if (init_dbscan(&raw, MAX_N) < 0 || init_dbscan(&dd, MAX_N) < 0)
+		return 1;
+
+	check_exact(nframe);
+	check_quantized(nframe);
+
+	del_dbscan(&raw);
+	del_dbscan(&dd);
+
+	return 0;
+}
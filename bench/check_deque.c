@@ -0,0 +1,296 @@
+/*
+ * check_deque.c
+ *
+ *  用随机操作序列对比struct deque与一个简单的参考模型(足够大的环形数组)，
+ *  覆盖两端的放入/取出、下标访问、批量操作和不检查的快速版本，
+ *  每步比较返回值、元素个数和取出的元素，不一致时打印步数并退出.
+ *  放入与取出的比例每PHASE步交替偏向一边，使队列反复涨落，
+ *  DYNAMIC模式下会多次扩容(和缩小)，STATIC模式下会多次到满.
+ *  静态、动态、动态+缩小三种模式各编译一次，见Makefile的check目标.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=address,undefined -I../deque -I../pool -o check_deque \
+ *          check_deque.c ../deque/deque.c ../pool/pool.c
+ *  或make check
+ *
+ *  用法: ./check_deque [操作次数] [随机种子]
+ */
+
+#include "deque.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MODEL_SIZE (1 << 20)    /* 参考模型的长度，必须是2的幂 */
+#define MODEL_MASK (MODEL_SIZE - 1)
+#define PHASE      (20000)      /* 每PHASE步切换一次偏向 */
+#define BULK_MAX   (64)        /* 批量操作的最大个数 */
+#define ERR_MASK   (0xFFFF)     /* 满或空时约每65536次检查一次出错返回，其余跳过，少打印 */
+
+#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
+#define LIMIT     (DEQUE_MAX_NUM)
+#define MODE_NAME "static"
+#else
+#define LIMIT     (MODEL_SIZE - 1)
+#if DEQUE_SHRINK
+#define MODE_NAME "dynamic+shrink"
+#else
+#define MODE_NAME "dynamic"
+#endif
+#endif
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("step %ld: %s failed, size %d, model %u\n", step, #cond, deque_size(&q), n); \
+            exit(1); \
+        } \
+    } while (0)
+
+static struct deque q;
+static qdata model[MODEL_SIZE];
+static unsigned int head, n;    /* 模型中第一个元素的位置和元素个数 */
+static unsigned int rng;
+static long step;
+
+static unsigned int rnd(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+
+    return rng;
+}
+
+static int rare(void)
+{
+    return (rnd() & ERR_MASK) == 0;
+}
+
+/* 满时不放入，STATIC模式下偶尔检查出错返回 */
+static int full(int k, int (*push)(struct deque *, qdata))
+{
+    if (n + k <= LIMIT)
+        return 0;
+
+#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
+    if (rare() && push)
+        CHECK(push(&q, 0) == -2);
+#else
+    (void)push;
+#endif
+    return 1;
+}
+
+/* 空时不取出，偶尔检查出错返回 */
+static int empty(int (*get)(struct deque *, qdata *))
+{
+    qdata v;
+
+    if (n)
+        return 0;
+
+    if (rare())
+        CHECK(get(&q, &v) == -2);
+    return 1;
+}
+
+static void push_back(void)
+{
+    qdata v = (qdata)rnd();
+
+    if (full(1, deque_push_back))
+        return;
+
+    CHECK(deque_push_back(&q, v) == 0);
+    model[(head + n) & MODEL_MASK] = v;
+    ++n;
+}
+
+static void push_front(void)
+{
+    qdata v = (qdata)rnd();
+
+    if (full(1, deque_push_front))
+        return;
+
+    CHECK(deque_push_front(&q, v) == 0);
+    model[--head & MODEL_MASK] = v;
+    ++n;
+}
+
+static void push_back_n(void)
+{
+    qdata src[BULK_MAX];
+    int i, k = 1 + rnd() % BULK_MAX;
+
+    for (i = 0; i < k; ++i)
+        src[i] = (qdata)rnd();
+
+    if (full(k, NULL)) {
+#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
+        /* 空间不足时一个也不放入 */
+        if (rare())
+            CHECK(deque_push_back_n(&q, src, k) == -2);
+#endif
+        return;
+    }
+
+    CHECK(deque_push_back_n(&q, src, k) == 0);
+    for (i = 0; i < k; ++i)
+        model[(head + n++) & MODEL_MASK] = src[i];
+}
+
+/* 快速版本在DYNAMIC模式下不扩容，只在有空间时使用 */
+static void push_fast(void)
+{
+    qdata v = (qdata)rnd();
+
+    if (n == LIMIT || deque_room(&q) <= 0)
+        return;
+
+    if (rnd() & 1) {
+        deque_push_back_fast(&q, v);
+        model[(head + n) & MODEL_MASK] = v;
+    } else {
+        deque_push_front_fast(&q, v);
+        model[--head & MODEL_MASK] = v;
+    }
+    ++n;
+}
+
+static void pop_front(void)
+{
+    qdata v;
+
+    if (empty(deque_pop_front))
+        return;
+
+    CHECK(deque_pop_front(&q, &v) == 0);
+    CHECK(v == model[head++ & MODEL_MASK]);
+    --n;
+}
+
+static void pop_back(void)
+{
+    qdata v;
+
+    if (empty(deque_pop_back))
+        return;
+
+    CHECK(deque_pop_back(&q, &v) == 0);
+    CHECK(v == model[(head + --n) & MODEL_MASK]);
+}
+
+static void pop_front_n(void)
+{
+    qdata to[BULK_MAX];
+    int i, k = rnd() % (BULK_MAX + 1), got;
+
+    got = deque_pop_front_n(&q, to, k);
+    CHECK(got == (k < (int)n ? k : (int)n));
+
+    for (i = 0; i < got; ++i)
+        CHECK(to[i] == model[head++ & MODEL_MASK]);
+    n -= got;
+}
+
+static void pop_fast(void)
+{
+    if (n == 0)
+        return;
+
+    if (rnd() & 1)
+        CHECK(deque_pop_front_fast(&q) == model[head++ & MODEL_MASK]);
+    else
+        CHECK(deque_pop_back_fast(&q) == model[(head + n - 1) & MODEL_MASK]);
+    --n;
+}
+
+/* front、back和at，检查版本与快速版本 */
+static void peek(void)
+{
+    qdata v;
+    int i;
+
+    if (empty(deque_front) || empty(deque_back))
+        return;
+
+    CHECK(deque_front(&q, &v) == 0 && v == model[head & MODEL_MASK]);
+    CHECK(deque_back(&q, &v) == 0 && v == model[(head + n - 1) & MODEL_MASK]);
+    CHECK(deque_front_fast(&q) == model[head & MODEL_MASK]);
+    CHECK(deque_back_fast(&q) == model[(head + n - 1) & MODEL_MASK]);
+
+    i = rnd() % n;
+    CHECK(deque_at(&q, i, &v) == 0 && v == model[(head + i) & MODEL_MASK]);
+    CHECK(deque_at_fast(&q, i) == model[(head + i) & MODEL_MASK]);
+
+    if (rare()) {
+        CHECK(deque_at(&q, -1, &v) == -2);
+        CHECK(deque_at(&q, n, &v) == -2);
+    }
+}
+
+/* 逐个比较全部元素 */
+static void scan(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; ++i)
+        CHECK(deque_at_fast(&q, i) == model[(head + i) & MODEL_MASK]);
+}
+
+int main(int argc, char *argv[])
+{
+    long steps = argc > 1 ? atol(argv[1]) : 3000000;
+    unsigned int peak = 0;
+    int bias, op;
+
+    rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20240605;
+    if (!rng)
+        rng = 1;
+
+    CHECK(deque_init(&q) == 0);
+
+    for (step = 0; step < steps; ++step) {
+        /* 256分之bias的概率放入 */
+        bias = (step / PHASE) & 1 ? 80 : 160;
+        op = rnd() & 255;
+
+        if (rare()) {
+            scan();
+            deque_clear(&q);
+            n = 0;
+        } else if (op < bias) {
+            switch (op & 3) {
+            case 0: push_back(); break;
+            case 1: push_front(); break;
+            case 2: push_back_n(); break;
+            default: push_fast(); break;
+            }
+        } else if (op < 240) {
+            switch (op & 3) {
+            case 0: pop_front(); break;
+            case 1: pop_back(); break;
+            case 2: pop_front_n(); break;
+            default: pop_fast(); break;
+            }
+        } else {
+            peek();
+        }
+
+        CHECK(deque_size(&q) == (int)n);
+        CHECK(deque_empty(&q) == (n == 0));
+#if INIT_DEQUE_MEASURE == DYNAMIC_DEQUE_MALLOC
+        CHECK(q.mask + 1 >= (int)n);
+#else
+        CHECK(deque_room(&q) == (int)(LIMIT - n));
+#endif
+        if (n > peak)
+            peak = n;
+    }
+
+    scan();
+    deque_destroy(&q);
+    printf("check_deque %s: %ld steps ok, peak size %u\n", MODE_NAME, steps, peak);
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * check_deque_hpp.cpp
+ *
+ *  用随机操作序列对比ctl::ring_deque、ctl::static_deque与std::deque，
+ *  元素类型item持有一个unique_ptr并统计存活的实例数，
+ *  检查元素的值、个数，以及析构后没有遗留的实例.
+ *  另外在队列刚好满时用队列自己的元素放入(d.push_back(d.front())等)，
+ *  ring_deque此时扩容，新元素必须在旧缓冲区释放之前构造.
+ *
+ *  编译(主机):
+ *      g++ -O1 -g -fsanitize=address,undefined -I../deque -o check_deque_hpp check_deque_hpp.cpp
+ *  或make check
+ *
+ *  用法: ./check_deque_hpp [操作次数] [随机种子]
+ */
+
+#include "deque.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#define PHASE (20000)    /* 每PHASE步切换一次偏向 */
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            std::printf("%s step %ld: %s failed\n", name, step, #cond); \
+            std::exit(1); \
+        } \
+    } while (0)
+
+/* 只能通过指针取值，复制已析构或已移走的元素时ASan或空指针会报错 */
+struct item {
+    static long live;
+
+    explicit item(unsigned v) : p(new unsigned(v)) { ++live; }
+    item(const item &o) : p(new unsigned(*o.p)) { ++live; }
+    item(item &&o) noexcept : p(std::move(o.p)) { ++live; }
+    item &operator=(item &&o) noexcept { p = std::move(o.p); return *this; }
+    ~item() { --live; }
+
+    unsigned value() const { return *p; }
+
+    std::unique_ptr<unsigned> p;
+};
+
+long item::live = 0;
+
+static unsigned int rng;
+static long step;
+
+static unsigned int rnd()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+
+    return rng;
+}
+
+/* 放入一个元素，队列满且不能扩容时model不变 */
+template <class D>
+static void push(const char *name, D &d, std::deque<unsigned> &model, bool back, const item &v)
+{
+    bool full = d.full();
+    unsigned x = v.value();
+    bool ok = back ? d.push_back(v) : d.push_front(v);
+
+    CHECK(ok || full);
+    if (!ok)
+        return;
+    if (back)
+        model.push_back(x);
+    else
+        model.push_front(x);
+}
+
+template <class D>
+static void compare(const char *name, const D &d, const std::deque<unsigned> &model)
+{
+    std::size_t i;
+
+    CHECK(d.size() == model.size());
+    CHECK(d.empty() == model.empty());
+    for (i = 0; i < model.size(); ++i)
+        CHECK(d[i].value() == model[i]);
+}
+
+template <class D>
+static void run(const char *name, D &d, long steps)
+{
+    std::deque<unsigned> model;
+    std::size_t peak = 0;
+    int bias, op;
+    long grows = 0;
+
+    for (step = 0; step < steps; ++step) {
+        /* 256分之bias的概率放入 */
+        bias = (step / PHASE) & 1 ? 80 : 160;
+        op = rnd() & 255;
+
+        if (op < bias) {
+            /* 非空时约一半用队列自己的元素放入 */
+            if (!d.empty() && (op & 1)) {
+                std::size_t i = rnd() % d.size();
+                grows += d.full();
+                push(name, d, model, op & 2, op & 4 ? d[i] : (op & 8 ? d.front() : d.back()));
+            } else if (op & 4) {
+                unsigned x = rnd();
+                if (op & 2 ? d.emplace_back(x) : d.emplace_front(x)) {
+                    if (op & 2)
+                        model.push_back(x);
+                    else
+                        model.push_front(x);
+                }
+            } else {
+                push(name, d, model, op & 2, item(rnd()));
+            }
+        } else if (op < 240) {
+            if (d.empty()) {
+                item to(0);
+                CHECK(!d.try_pop_front(to) && !d.try_pop_back(to));
+            } else if (op & 1) {
+                CHECK(d.front().value() == model.front());
+                d.pop_front();
+                model.pop_front();
+            } else {
+                item to(0);
+                CHECK(d.try_pop_back(to) && to.value() == model.back());
+                model.pop_back();
+            }
+        } else if (op < 255) {
+            compare(name, d, model);
+        } else {
+            d.clear();
+            model.clear();
+        }
+
+        CHECK(d.size() == model.size());
+        CHECK(item::live == (long)d.size());
+        if (d.size() > peak)
+            peak = d.size();
+    }
+
+    compare(name, d, model);
+    std::printf("check_deque_hpp %s: %ld steps ok, peak size %zu, %ld self pushes when full\n",
+                name, steps, peak, grows);
+}
+
+/* ring_deque在每个容量上刚好满时用自己的元素放入，两端各一次 */
+static void self_push()
+{
+    const char *name = "ring_deque self push";
+    ctl::ring_deque<item> d;
+    std::deque<unsigned> model;
+    std::size_t i;
+
+    for (step = 0; d.size() < 8192; ++step) {
+        /* 空队列的容量为0，也算满 */
+        if (d.empty() || !d.full()) {
+            unsigned x = rnd();
+            CHECK(d.push_back(item(x)));
+            model.push_back(x);
+            continue;
+        }
+
+        switch (step & 3) {
+        case 0: push(name, d, model, true, d.front()); break;
+        case 1: push(name, d, model, false, d.back()); break;
+        case 2: push(name, d, model, true, d[d.size() / 2]); break;
+        default: push(name, d, model, false, d[d.size() - 1]); break;
+        }
+        CHECK(!d.full());
+        compare(name, d, model);
+
+        /* 前端放入后head不在0，下一次扩容时环是绕回的 */
+        for (i = 0; i < 3; ++i) {
+            unsigned x = rnd();
+            CHECK(d.push_front(item(x)));
+            model.push_front(x);
+        }
+    }
+    compare(name, d, model);
+
+    /* 移动赋值后d为空，元素只析构一次 */
+    ctl::ring_deque<item> e;
+    CHECK(e.push_back(item(1)));
+    e = std::move(d);
+    CHECK(d.size() == 0 && d.capacity() == 0);
+    compare(name, e, model);
+    CHECK(item::live == (long)model.size());
+
+    std::printf("check_deque_hpp %s: ok, size %zu\n", name, e.size());
+}
+
+int main(int argc, char *argv[])
+{
+    long steps = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    rng = argc > 2 ? (unsigned int)std::strtoul(argv[2], NULL, 0) : 20241001;
+    if (!rng)
+        rng = 1;
+
+    {
+        ctl::ring_deque<item> d;
+        run("ring_deque", d, steps);
+    }
+    {
+        ctl::static_deque<item, 256> d;
+        run("static_deque<256>", d, steps);
+    }
+    self_push();
+
+    if (item::live) {
+        std::printf("check_deque_hpp: %ld items not destroyed\n", item::live);
+        return 1;
+    }
+
+    return 0;
+}
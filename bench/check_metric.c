@@ -0,0 +1,344 @@
+/*
+ * check_metric.c
+ *
+ *  用64位穷举的参考实现检查metric.h与nbr_kernel():
+ *      metric_within: 随机点对，各维的差值在e/权重附近，距离常落在e的两侧;
+ *          metric_aoa_diff另取差值在半个周期附近的点对;
+ *      metric_aoa_ranges: 返回的区间合法、互不重叠，覆盖所有aoa差值不超过r的点，
+ *          不取整个周期时区间内的点差值都不超过r; 点取在0与周期两侧，跨过回绕点;
+ *          不回绕时a取在0与UINT_MAX附近，检查区间的截断;
+ *      metric_within为真时另一点的aoa在区间内，pw差值不超过METRIC_R_PW(e);
+ *      nbr_kernel: 与逐点的参考结果相同，序号按升序.
+ *  周期不大于MAX_EXHAUST时对每个a、各个r穷举整个周期，并穷举metric_aoa_diff.
+ *  度量方式、权重、周期为编译时选项，Makefile按几组选项各编译一次.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=address,undefined -march=native -Ihost -I../signal_proc/dbscan \
+ *          -I../deque -I../stack -I../pool -DMETRIC_MEASURE=2 -DMETRIC_FREQ=1 \
+ *          '-DMETRIC_AOA_PERIOD=(360u << 20)' -o check_metric check_metric.c \
+ *          ../signal_proc/dbscan/nbr_kernel.c
+ *  或make check
+ *
+ *  用法: ./check_metric [点对数] [随机种子]
+ */
+
+#include "nbr_kernel.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NKERNEL     (80)		/* nbr_kernel每次比较的点数，含不足16个的尾部 */
+#define MAX_EXHAUST (4096)
+
+/* 不回绕时各维的取值范围，加权后的差值与L1的和不溢出 */
+#define DOMAIN      (1u << 28)
+
+#if METRIC_AOA_PERIOD
+#define AOA_DOMAIN  (METRIC_AOA_PERIOD)
+#else
+#define AOA_DOMAIN  (DOMAIN)
+#endif
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			printf("%s case %ld: %s failed\n", name, step, #cond); \
+			exit(1); \
+		} \
+	} while (0)
+
+static unsigned int aoa[NKERNEL], freq[NKERNEL], pw[NKERNEL];
+static pt_index_t nbrs[NKERNEL];
+static const char *name;
+static unsigned int rng;
+static long step;
+
+static unsigned int rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+/* 参考实现: 64位有符号差值，回绕时取两个方向中较短的 */
+static unsigned long long ref_aoa_diff(unsigned int a, unsigned int b)
+{
+	long long d = (long long)a - (long long)b;
+
+	if (d < 0)
+		d = -d;
+#if METRIC_AOA_PERIOD
+	if (d > (long long)METRIC_AOA_PERIOD - d)
+		d = (long long)METRIC_AOA_PERIOD - d;
+#endif
+
+	return (unsigned long long)d;
+}
+
+static unsigned long long ref_diff(unsigned int a, unsigned int b)
+{
+	return a > b ? (unsigned long long)a - b : (unsigned long long)b - a;
+}
+
+static int ref_within(unsigned int a1, unsigned int f1, unsigned int p1,
+		unsigned int a2, unsigned int f2, unsigned int p2, unsigned int e)
+{
+	unsigned long long da = METRIC_W_AOA * ref_aoa_diff(a1, a2);
+	unsigned long long dp = METRIC_W_PW * ref_diff(p1, p2);
+	unsigned long long df = METRIC_FREQ ? METRIC_W_FREQ * ref_diff(f1, f2) : 0;
+
+#if METRIC_MEASURE == METRIC_L1
+	return da + df + dp <= e;
+#elif METRIC_MEASURE == METRIC_LINF
+	return da <= e && df <= e && dp <= e;
+#else
+	return da * da + df * df + dp * dp <= (unsigned long long)e * e;
+#endif
+}
+
+/* c附近、与c的差值约为0~2r的值，限制在[0, domain)内; 回绕时按周期取模 */
+static unsigned int near(unsigned int c, unsigned int r, unsigned int domain, int wrap)
+{
+	long long v = (long long)c + (long long)(rnd() % (4ull * r + 3)) - 2 * (long long)r - 1;
+
+	if (wrap) {
+		v %= domain;
+		return (unsigned int)(v < 0 ? v + domain : v);
+	}
+
+	return v < 0 ? 0 : v >= domain ? domain - 1 : (unsigned int)v;
+}
+
+/* 0或周期(不回绕时为0或UINT_MAX)附近的aoa */
+static unsigned int aoa_at_edge(unsigned int r)
+{
+	unsigned int off = rnd() % (2ull * r + 2);
+
+#if METRIC_AOA_PERIOD
+	return rnd() & 1 ? off % METRIC_AOA_PERIOD
+			: METRIC_AOA_PERIOD - 1 - off % METRIC_AOA_PERIOD;
+#else
+	return rnd() & 1 ? off : UINT_MAX - off;
+#endif
+}
+
+/* e取各个数量级，小e时距离常恰好等于e */
+static unsigned int rand_e(void)
+{
+	unsigned int e = rnd() >> (rnd() % 32);
+
+	return e % (DOMAIN / 2);
+}
+
+static int in_ranges(unsigned int x, int nr, const unsigned int lo[2], const unsigned int hi[2])
+{
+	int k;
+
+	for (k = 0; k < nr; ++k)
+		if (x >= lo[k] && x <= hi[k])
+			return 1;
+
+	return 0;
+}
+
+/* 区间合法，返回是否为整个周期 */
+static int check_ranges_shape(unsigned int a, unsigned int r, int nr,
+		const unsigned int lo[2], const unsigned int hi[2])
+{
+	int k;
+
+	CHECK(nr == 1 || nr == 2);
+	for (k = 0; k < nr; ++k) {
+		CHECK(lo[k] <= hi[k]);
+#if METRIC_AOA_PERIOD
+		CHECK(hi[k] < METRIC_AOA_PERIOD);
+#endif
+	}
+	if (nr == 2)
+		CHECK(hi[0] < lo[1] || hi[1] < lo[0]);
+
+#if METRIC_AOA_PERIOD
+	if (nr == 1 && lo[0] == 0 && hi[0] == METRIC_AOA_PERIOD - 1)
+		return 1;
+	/* 不取整个周期时两段的总长为2r + 1 */
+	CHECK(r < METRIC_AOA_PERIOD / 3);
+	CHECK((hi[0] - lo[0] + 1ull) + (nr == 2 ? hi[1] - lo[1] + 1ull : 0) == 2ull * r + 1);
+#else
+	CHECK(nr == 1);
+	CHECK(lo[0] == (a > r ? a - r : 0));
+	CHECK(hi[0] == (a + (unsigned long long)r > UINT_MAX ? UINT_MAX : a + r));
+#endif
+
+	return 0;
+}
+
+/* 区间的端点、端点外一个以及区间内外的随机点 */
+static void check_ranges_at(unsigned int a, unsigned int r)
+{
+	unsigned int lo[2], hi[2], x;
+	int nr = metric_aoa_ranges(a, r, lo, hi);
+	int whole = check_ranges_shape(a, r, nr, lo, hi);
+	int k, i;
+
+	for (k = 0; k < nr; ++k) {
+		CHECK(whole || ref_aoa_diff(a, lo[k]) <= r);
+		CHECK(whole || ref_aoa_diff(a, hi[k]) <= r);
+	}
+
+	for (i = 0; i < 16; ++i) {
+		x = near(a, r, AOA_DOMAIN, METRIC_AOA_PERIOD != 0);
+		if (!METRIC_AOA_PERIOD && (i & 1))
+			x = (unsigned int)(a + (rnd() % (4ull * r + 3)) - 2ull * r - 1);
+		if (ref_aoa_diff(a, x) <= r)
+			CHECK(in_ranges(x, nr, lo, hi));
+		else
+			CHECK(whole || !in_ranges(x, nr, lo, hi));
+	}
+}
+
+#if METRIC_AOA_PERIOD && METRIC_AOA_PERIOD <= MAX_EXHAUST
+/* 周期较小时对每个a、各个r穷举整个周期 */
+static void check_ranges_exhaust(void)
+{
+	static const unsigned int rs[] = { 0, 1, 2, 3, METRIC_AOA_PERIOD / 3 - 1,
+			METRIC_AOA_PERIOD / 3, METRIC_AOA_PERIOD / 2, METRIC_AOA_PERIOD };
+	unsigned int lo[2], hi[2], a, x, r;
+	int i, nr, whole;
+
+	name = "aoa ranges, exhaustive";
+	step = 0;
+	for (i = 0; i < (int)(sizeof(rs) / sizeof(rs[0])) + 4; ++i) {
+		r = i < (int)(sizeof(rs) / sizeof(rs[0])) ? rs[i] : rnd() % (METRIC_AOA_PERIOD / 3);
+		for (a = 0; a < METRIC_AOA_PERIOD; ++a, ++step) {
+			nr = metric_aoa_ranges(a, r, lo, hi);
+			whole = check_ranges_shape(a, r, nr, lo, hi);
+			for (x = 0; x < METRIC_AOA_PERIOD; ++x) {
+				if (i == 0)
+					CHECK(metric_aoa_diff(a, x) == ref_aoa_diff(a, x));
+				if (ref_aoa_diff(a, x) <= r)
+					CHECK(in_ranges(x, nr, lo, hi));
+				else
+					CHECK(whole || !in_ranges(x, nr, lo, hi));
+			}
+		}
+	}
+
+	printf("check_metric %s: %ld cases ok\n", name, step);
+}
+#endif
+
+static void check_pairs(long steps)
+{
+	unsigned int a1, f1, p1, a2, f2, p2, e, lo[2], hi[2];
+	long nin = 0;
+	int in, nr;
+
+	name = "pairs";
+	for (step = 0; step < steps; ++step) {
+		e = rand_e();
+
+		/* 一半的点对取在aoa的0与周期附近 */
+		a1 = step & 1 ? aoa_at_edge(METRIC_R_AOA(e)) % AOA_DOMAIN : rnd() % AOA_DOMAIN;
+		f1 = rnd() % DOMAIN;
+		p1 = rnd() % DOMAIN;
+		a2 = near(a1, METRIC_R_AOA(e), AOA_DOMAIN, METRIC_AOA_PERIOD != 0);
+		f2 = near(f1, METRIC_R_FREQ(e), DOMAIN, 0);
+		p2 = near(p1, METRIC_R_PW(e), DOMAIN, 0);
+#if METRIC_AOA_PERIOD
+		/* 差值在半个周期附近，两个方向的长度相当 */
+		if ((step & 7) == 2)
+			a2 = (a1 + METRIC_AOA_PERIOD / 2 + rnd() % 5 - 2) % METRIC_AOA_PERIOD;
+#endif
+
+		CHECK(metric_aoa_diff(a1, a2) == ref_aoa_diff(a1, a2));
+		in = metric_within(a1, f1, p1, a2, f2, p2, e);
+		CHECK(in == ref_within(a1, f1, p1, a2, f2, p2, e));
+		CHECK(in == metric_within(a2, f2, p2, a1, f1, p1, e));
+		nin += in;
+
+		/* e领域在各维半径之内，网格与排序窗口不会漏掉 */
+		if (in) {
+			nr = metric_aoa_ranges(a1, METRIC_R_AOA(e), lo, hi);
+			CHECK(in_ranges(a2, nr, lo, hi));
+			CHECK(ref_diff(p1, p2) <= METRIC_R_PW(e));
+			CHECK(!METRIC_FREQ || ref_diff(f1, f2) <= METRIC_R_FREQ(e));
+		}
+	}
+
+	printf("check_metric %s: %ld pairs ok, %ld within e\n", name, steps, nin);
+}
+
+static void check_ranges(long steps)
+{
+	unsigned int a, r;
+
+	name = "aoa ranges";
+	for (step = 0; step < steps; ++step) {
+		r = rand_e() / METRIC_W_AOA;
+		if ((step & 7) == 0)
+			r = rnd() % (AOA_DOMAIN / 2);
+		a = step & 1 ? aoa_at_edge(r) : rnd() % AOA_DOMAIN;
+		check_ranges_at(a, r);
+	}
+
+	printf("check_metric %s: %ld cases ok\n", name, steps);
+}
+
+/* 每次NKERNEL个点，围绕查询点，逐点与参考实现比较 */
+static void check_kernel(long steps)
+{
+	unsigned int qa, qf, qp, e;
+	long total = 0;
+	int j, m, n, nnbr;
+
+	name = "nbr_kernel";
+	for (step = 0; step < steps; ++step) {
+		e = rand_e();
+		n = rnd() % (NKERNEL + 1);
+		qa = step & 1 ? aoa_at_edge(METRIC_R_AOA(e)) % AOA_DOMAIN : rnd() % AOA_DOMAIN;
+		qf = rnd() % DOMAIN;
+		qp = rnd() % DOMAIN;
+
+		for (j = 0; j < n; ++j) {
+			aoa[j] = near(qa, METRIC_R_AOA(e), AOA_DOMAIN, METRIC_AOA_PERIOD != 0);
+			freq[j] = near(qf, METRIC_R_FREQ(e), DOMAIN, 0);
+			pw[j] = near(qp, METRIC_R_PW(e), DOMAIN, 0);
+		}
+
+		nnbr = nbr_kernel(aoa, freq, pw, n, qa, qf, qp, e, nbrs);
+		CHECK(nnbr >= 0 && nnbr <= n);
+		for (j = 0, m = 0; j < n; ++j) {
+			if (!ref_within(qa, qf, qp, aoa[j], freq[j], pw[j], e))
+				continue;
+			CHECK(m < nnbr && nbrs[m] == j);
+			++m;
+		}
+		CHECK(m == nnbr);
+		total += nnbr;
+	}
+
+	printf("check_metric %s: %ld queries ok, %ld neighbours\n", name, steps, total);
+}
+
+int main(int argc, char *argv[])
+{
+	long steps = argc > 1 ? atol(argv[1]) : 2000000;
+
+	rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20240902;
+	if (!rng)
+		rng = 1;
+
+	printf("check_metric: measure %d, freq %d, weights %d/%d/%d, aoa period %u\n",
+			METRIC_MEASURE, METRIC_FREQ, METRIC_W_AOA, METRIC_W_FREQ, METRIC_W_PW,
+			(unsigned int)METRIC_AOA_PERIOD);
+
+	check_pairs(steps);
+	check_ranges(steps);
+	check_kernel(steps / 20);
+#if METRIC_AOA_PERIOD && METRIC_AOA_PERIOD <= MAX_EXHAUST
+	check_ranges_exhaust();
+#endif
+
+	return 0;
+}
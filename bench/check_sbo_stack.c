@@ -0,0 +1,299 @@
+/*
+ * check_sbo_stack.c
+ *
+ *  检查sbo_stack:
+ *      从结构体内的存储溢出到arena，溢出区的初始大小;
+ *      只有一个栈时溢出区位于arena末尾，加倍时原地扩展，地址不变;
+ *      两个栈交替溢出时溢出区不在末尾，加倍时申请新区并复制;
+ *      arena为NULL或arena已满时push返回-1，栈中原有的元素不变;
+ *  然后用随机的压栈、出栈序列对比共用一个arena的几个栈与各自的参考数组，
+ *  arena用掉1/4时整体重置.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=address,undefined -I../stack -I../pool -o check_sbo_stack \
+ *          check_sbo_stack.c ../stack/sbo_stack.c
+ *  或make check
+ *
+ *  用法: ./check_sbo_stack [操作次数] [随机种子]
+ */
+
+#include "sbo_stack.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NSTACK      (3)
+#define MODEL_SIZE  (1 << 16)
+#define ARENA_BYTES (32 * 1024)		/* 随机测试的arena，按实际大小申请，越界时ASan报错 */
+#define PHASE       (2000)			/* 每PHASE步切换一次偏向 */
+#define CLEAR_MASK  (0x1FFF)			/* 约每8192步清空一个栈，保留其溢出区 */
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			printf("%s step %ld: %s failed\n", name, step, #cond); \
+			exit(1); \
+		} \
+	} while (0)
+
+static struct sbo_stack st[NSTACK];
+static ST_data_type model[NSTACK][MODEL_SIZE];
+static unsigned int n[NSTACK];
+static const char *name;
+static unsigned int rng;
+static long step;
+
+static unsigned int rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+/* 不出栈，直接比较第k个栈中的全部元素 */
+static void compare(int k)
+{
+	struct sbo_stack *s = &st[k];
+	unsigned int i;
+
+	CHECK(sbo_stack_size(s) == n[k]);
+	CHECK(sbo_stack_empty(s) == (n[k] == 0));
+	for (i = 0; i < n[k]; ++i) {
+		if (i < SBO_STACK_INLINE)
+			CHECK(s->local[i] == model[k][i]);
+		else
+			CHECK(s->spill[i - SBO_STACK_INLINE] == model[k][i]);
+	}
+}
+
+/* 压入m个元素，都应成功 */
+static void fill(int k, unsigned int m)
+{
+	ST_data_type v;
+
+	while (m--) {
+		v = (ST_data_type)rnd();
+		CHECK(sbo_stack_push(&st[k], v) == 0);
+		model[k][n[k]++] = v;
+	}
+}
+
+/* 逐个出栈比较 */
+static void drain(int k)
+{
+	ST_data_type v;
+
+	while (n[k]) {
+		CHECK(sbo_stack_pop(&st[k], &v) == 0);
+		CHECK(v == model[k][--n[k]]);
+	}
+	CHECK(sbo_stack_pop(&st[k], &v) == -1);
+}
+
+static void check_spill(void)
+{
+	static char buf[4096];
+	struct stack_arena a;
+	ST_data_type *spill;
+
+	name = "spill";
+	stack_arena_init(&a, buf, sizeof(buf));
+	CHECK(sbo_stack_init(&st[0], &a) == 0);
+	n[0] = 0;
+
+	/* 结构体内的存储用满之前不申请溢出区 */
+	fill(0, SBO_STACK_INLINE);
+	CHECK(st[0].spill == NULL && st[0].spill_size == 0 && a.used == 0);
+
+	fill(0, 1);
+	CHECK(st[0].spill != NULL && st[0].spill_size == SBO_SPILL_MIN);
+	CHECK(a.used == SBO_SPILL_MIN * sizeof(ST_data_type));
+	compare(0);
+
+	/* 唯一的溢出区在arena末尾，原地扩展 */
+	spill = st[0].spill;
+	fill(0, SBO_SPILL_MIN);
+	CHECK(st[0].spill == spill && st[0].spill_size == 2 * SBO_SPILL_MIN);
+	CHECK(a.used == 2 * SBO_SPILL_MIN * sizeof(ST_data_type));
+	compare(0);
+
+	/* 清空后保留溢出区，再次溢出不申请 */
+	sbo_stack_clear(&st[0]);
+	n[0] = 0;
+	fill(0, SBO_STACK_INLINE + SBO_SPILL_MIN);
+	CHECK(st[0].spill == spill && a.used == 2 * SBO_SPILL_MIN * sizeof(ST_data_type));
+	drain(0);
+
+	printf("check_sbo_stack %s: ok\n", name);
+}
+
+static void check_interleave(void)
+{
+	static char buf[16384];
+	struct stack_arena a;
+	ST_data_type *spill;
+	unsigned int used;
+
+	name = "interleave";
+	stack_arena_init(&a, buf, sizeof(buf));
+	CHECK(sbo_stack_init(&st[0], &a) == 0);
+	CHECK(sbo_stack_init(&st[1], &a) == 0);
+	n[0] = n[1] = 0;
+
+	fill(0, SBO_STACK_INLINE + 1);
+	fill(1, SBO_STACK_INLINE + 1);
+	CHECK(st[1].spill > st[0].spill);
+
+	/* 0的溢出区后面是1的，加倍时复制到新区 */
+	spill = st[0].spill;
+	used = a.used;
+	fill(0, SBO_SPILL_MIN);
+	CHECK(st[0].spill != spill && st[0].spill > st[1].spill);
+	CHECK(st[0].spill_size == 2 * SBO_SPILL_MIN);
+	CHECK(a.used == used + 2 * SBO_SPILL_MIN * sizeof(ST_data_type));
+	compare(0);
+	compare(1);
+
+	/* 1的溢出区也不在末尾了 */
+	spill = st[1].spill;
+	fill(1, SBO_SPILL_MIN);
+	CHECK(st[1].spill != spill && st[1].spill > st[0].spill);
+	compare(0);
+	compare(1);
+
+	/* 0再加倍仍要复制; 之后0在末尾，再加倍时原地扩展 */
+	fill(0, SBO_SPILL_MIN);
+	CHECK(st[0].spill_size == 4 * SBO_SPILL_MIN && st[0].spill > st[1].spill);
+	spill = st[0].spill;
+	fill(0, 4 * SBO_SPILL_MIN - st[0].capacity + SBO_STACK_INLINE + 1);
+	CHECK(st[0].spill == spill && st[0].spill_size == 8 * SBO_SPILL_MIN);
+	compare(0);
+	compare(1);
+
+	drain(0);
+	drain(1);
+	printf("check_sbo_stack %s: ok\n", name);
+}
+
+static void check_fail(void)
+{
+	static char buf[SBO_SPILL_MIN * sizeof(ST_data_type) + 8];
+	struct stack_arena a;
+	ST_data_type v;
+
+	/* 没有arena时只能存放SBO_STACK_INLINE个元素 */
+	name = "null arena";
+	CHECK(sbo_stack_init(&st[0], NULL) == 0);
+	n[0] = 0;
+	fill(0, SBO_STACK_INLINE);
+	CHECK(sbo_stack_push(&st[0], 1) == -1);
+	CHECK(st[0].spill == NULL);
+	compare(0);
+	drain(0);
+
+	/* arena只够初始的溢出区，加倍失败，已有的元素和溢出区不变 */
+	name = "arena full";
+	stack_arena_init(&a, buf, sizeof(buf));
+	CHECK(sbo_stack_init(&st[0], &a) == 0);
+	fill(0, SBO_STACK_INLINE + SBO_SPILL_MIN);
+	CHECK(sbo_stack_push(&st[0], 1) == -1);
+	CHECK(st[0].spill_size == SBO_SPILL_MIN);
+	compare(0);
+
+	/* 重置后重新初始化即可再用 */
+	stack_arena_reset(&a);
+	CHECK(sbo_stack_init(&st[0], &a) == 0);
+	n[0] = 0;
+	fill(0, SBO_STACK_INLINE + 1);
+	CHECK(sbo_stack_pop(&st[0], &v) == 0 && v == model[0][--n[0]]);
+	drain(0);
+
+	printf("check_sbo_stack null arena, arena full: ok\n");
+}
+
+/* 几个栈共用一个arena，随机压栈、出栈 */
+static void check_random(long steps)
+{
+	char *buf = (char *)malloc(ARENA_BYTES);
+	struct stack_arena a;
+	ST_data_type v;
+	unsigned int peak = 0, nreset = 0, ninplace = 0, ncopy = 0;
+	ST_data_type *spill;
+	unsigned int size;
+	int bias, k;
+
+	name = "random";
+	CHECK(buf != NULL);
+	stack_arena_init(&a, buf, ARENA_BYTES);
+	for (k = 0; k < NSTACK; ++k) {
+		CHECK(sbo_stack_init(&st[k], &a) == 0);
+		n[k] = 0;
+	}
+
+	for (step = 0; step < steps; ++step) {
+		k = rnd() % NSTACK;
+		/* 256分之bias的概率压栈，各栈的偏向错开 */
+		bias = (step / PHASE + k) & 1 ? 96 : 168;
+
+		/* arena用掉1/4后整体重置，之后一次加倍最多再用1/2，不会失败; 出错返回由check_fail()检查 */
+		if (a.used > ARENA_BYTES / 4) {
+			stack_arena_reset(&a);
+			for (k = 0; k < NSTACK; ++k) {
+				CHECK(sbo_stack_init(&st[k], &a) == 0);
+				n[k] = 0;
+			}
+			++nreset;
+			continue;
+		}
+
+		if ((rnd() & CLEAR_MASK) == 0) {
+			sbo_stack_clear(&st[k]);
+			n[k] = 0;
+		} else if ((int)(rnd() & 255) < bias) {
+			v = (ST_data_type)rnd();
+			spill = st[k].spill;
+			size = st[k].spill_size;
+
+			CHECK(sbo_stack_push(&st[k], v) == 0);
+			model[k][n[k]++] = v;
+			if (st[k].spill_size != size) {
+				if (size && st[k].spill == spill)
+					++ninplace;
+				else if (size)
+					++ncopy;
+				compare(k);
+			}
+		} else if (n[k]) {
+			CHECK(sbo_stack_pop(&st[k], &v) == 0);
+			CHECK(v == model[k][--n[k]]);
+		} else {
+			CHECK(sbo_stack_pop(&st[k], &v) == -1);
+		}
+
+		if (n[k] > peak)
+			peak = n[k];
+	}
+
+	for (k = 0; k < NSTACK; ++k)
+		drain(k);
+	free(buf);
+
+	printf("check_sbo_stack %s: %ld steps ok, peak size %u, %u in-place and %u copy grows, "
+			"%u arena resets\n", name, steps, peak, ninplace, ncopy, nreset);
+}
+
+int main(int argc, char *argv[])
+{
+	long steps = argc > 1 ? atol(argv[1]) : 5000000;
+
+	rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20240923;
+	if (!rng)
+		rng = 1;
+
+	check_spill();
+	check_interleave();
+	check_fail();
+	check_random(steps);
+
+	return 0;
+}
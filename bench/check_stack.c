@@ -0,0 +1,140 @@
+/*
+ * check_stack.c
+ *
+ *  用随机的压栈、出栈、清空序列对比struct stack与一个参考数组，
+ *  每步比较返回值和出栈的元素，不一致时打印步数并退出.
+ *  压栈与出栈的比例每PHASE步交替偏向一边，使栈反复涨落，
+ *  DYNAMIC模式下反复跨过块的边界(STACK_CHUNK=4时几乎每步都跨).
+ *  静态、动态、动态且STACK_CHUNK=4三种情况各编译一次，见Makefile的check目标.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=address,undefined -I../stack -I../pool -o check_stack \
+ *          check_stack.c ../stack/stack.c ../pool/pool.c
+ *  或make check
+ *
+ *  用法: ./check_stack [操作次数] [随机种子]
+ */
+
+#include "stack.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MODEL_SIZE (1 << 20)	/* 参考数组的长度 */
+#define PHASE      (20000)		/* 每PHASE步切换一次偏向 */
+#define ERR_MASK   (0xFFFF)		/* 满或空时约每65536次检查一次出错返回，其余跳过，少打印 */
+
+#if INIT_MEASURE == STATIC
+#define LIMIT     (STACK_MAX_NUM)
+#define MODE_NAME "static"
+#else
+#define LIMIT     (MODEL_SIZE)
+#define MODE_NAME "dynamic, chunk %d"
+#endif
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			printf("step %ld: %s failed, size %u, model %u\n", step, #cond, st.capacity, n); \
+			exit(1); \
+		} \
+	} while (0)
+
+static struct stack st;
+static ST_data_type model[MODEL_SIZE];
+static unsigned int n;
+static unsigned int rng;
+static long step;
+
+static unsigned int rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+static int rare(void)
+{
+	return (rnd() & ERR_MASK) == 0;
+}
+
+static void check_push(void)
+{
+	ST_data_type v = (ST_data_type)rnd();
+
+	if (n == LIMIT) {
+#if INIT_MEASURE == STATIC
+		if (rare())
+			CHECK(stack_push(&st, v) == -1);
+#endif
+		return;
+	}
+
+	CHECK(stack_push(&st, v) == 0);
+	model[n++] = v;
+}
+
+static void check_pop(void)
+{
+	ST_data_type v;
+
+	if (n == 0) {
+		if (rare())
+			CHECK(stack_pop(&st, &v) == -1);
+		return;
+	}
+
+	CHECK(stack_pop(&st, &v) == 0);
+	CHECK(v == model[--n]);
+}
+
+int main(int argc, char *argv[])
+{
+	long steps = argc > 1 ? atol(argv[1]) : 3000000;
+	unsigned int peak = 0, nclear = 0;
+	int bias, op;
+
+	rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20231229;
+	if (!rng)
+		rng = 1;
+
+	CHECK(stack_init(&st) == 0);
+
+	for (step = 0; step < steps; ++step) {
+		/* 256分之bias的概率压栈 */
+		bias = (step / PHASE) & 1 ? 96 : 160;
+		op = rnd() & 255;
+
+		if (rare()) {
+			stack_clear(&st);
+			n = 0;
+			++nclear;
+		} else if (op < bias) {
+			check_push();
+		} else {
+			check_pop();
+		}
+
+		CHECK(st.capacity == n);
+#if INIT_MEASURE == DYNAMIC
+		/* 在块边界上当前块可能是刚空出的一块，也可能是下面已满的一块 */
+		CHECK(st.n <= STACK_CHUNK && st.n % STACK_CHUNK == n % STACK_CHUNK);
+#endif
+		if (n > peak)
+			peak = n;
+	}
+
+	/* 最后逐个出栈比较剩下的元素 */
+	while (n)
+		check_pop();
+
+	destroy_stack(&st);
+#if INIT_MEASURE == DYNAMIC
+	printf("check_stack " MODE_NAME, STACK_CHUNK);
+#else
+	printf("check_stack " MODE_NAME);
+#endif
+	printf(": %ld steps ok, peak size %u, %u clears\n", steps, peak, nclear);
+
+	return 0;
+}
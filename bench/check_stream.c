@@ -0,0 +1,265 @@
+/*
+ * check_stream.c
+ *
+ *  用随机的加入、移出、滑动序列检查dbscan_stream，每隔CMP_EVERY步
+ *  对窗口中的点调用dbscan()，比较:
+ *      核心点: 与穷举e领域的点数判断的结果相同;
+ *      核心点的划分: 两边的类编号一一对应，类的个数相同;
+ *      噪声点: 两边相同(边界点所归的类可以不同，只检查它归入了某个相邻核心点的类);
+ *      窗口外的槽: UNLABELED.
+ *  点由几个辐射源产生，辐射源的中心缓慢漂移，类随之合并、分裂;
+ *  aoa在0度附近两侧取值，定义METRIC_AOA_PERIOD时跨过回绕点.
+ *  另外用e=1、pw接近UINT_MAX的点检查网格行号的上限.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=address,undefined -Ihost -I../signal_proc/dbscan \
+ *          -I../deque -I../stack -I../pool -o check_stream check_stream.c \
+ *          ../signal_proc/dbscan/dbscan_stream.c ../signal_proc/dbscan/dbscan.c \
+ *          ../signal_proc/dbscan/nbr_index.c ../signal_proc/dbscan/nbr_kernel.c \
+ *          ../deque/deque.c ../pool/pool.c
+ *  或make check
+ *
+ *  用法: ./check_stream [操作次数] [随机种子]
+ */
+
+#include "dbscan_stream.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WINDOW     (192)		/* 窗口容量 */
+#define NEMITTER   (6)
+#define PHASE      (3000)		/* 每PHASE步切换一次偏向 */
+#define CMP_EVERY  (4)
+
+#define AOA_PERIOD (360u << 20)
+#define AOA_BAND   (12u << 20)	/* 辐射源中心在0度两侧各AOA_BAND内 */
+#define PW_CENTER  (20u << 20)
+#define PW_BAND    (6u << 20)
+#define DRIFT      (1u << 14)	/* 每步中心漂移的最大值 */
+
+#define CHECK(cond) do { \
+		if (!(cond)) { \
+			printf("%s step %ld: %s failed, %u points\n", name, step, #cond, s.npts); \
+			exit(1); \
+		} \
+	} while (0)
+
+static dbscan_stream_st s;
+static dbscan_st db;
+static ORIG_PDW win[WINDOW];		/* 按槽存放窗口中的点 */
+static ORIG_PDW src[WINDOW];		/* 按进入的先后存放，供dbscan() */
+static int map_s[WINDOW + 1];		/* 流的类编号 -> dbscan()的类编号 */
+static int map_d[WINDOW + 1];		/* dbscan()的类编号 -> 流的类编号 */
+static unsigned int e, minpts;
+static const char *name;
+static unsigned int rng;
+static long step;
+
+static unsigned int rnd(void)
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+/* [c - r, c + r]，aoa按周期回绕 */
+static unsigned int around_aoa(int c, unsigned int r)
+{
+	long long v = (long long)c + (long long)(rnd() % (2ull * r + 1)) - r;
+
+	v %= AOA_PERIOD;
+	return (unsigned int)(v < 0 ? v + AOA_PERIOD : v);
+}
+
+static unsigned int around_pw(int c, unsigned int r)
+{
+	return (unsigned int)(c + (long long)(rnd() % (2ull * r + 1)) - r);
+}
+
+static void compare(void)
+{
+	int i, k, p, q, a, b, core, cnt, near;
+
+	for (i = 0; i < (int)s.npts; ++i)
+		src[i] = win[(s.head + i) % s.window];
+
+	CHECK(reset_dbscan(&db, s.npts) == 0);
+	get_data(&db, src);
+	dbscan(&db, e, minpts);
+
+	memset(map_s, 0, sizeof(map_s));
+	memset(map_d, 0, sizeof(map_d));
+
+	for (i = 0; i < (int)s.npts; ++i) {
+		p = (s.head + i) % s.window;
+		a = dbscan_stream_label(&s, p);
+		b = db.major[i];
+
+		cnt = 0;
+		near = 0;
+		for (k = 0; k < (int)s.npts; ++k) {
+			q = (s.head + k) % s.window;
+			if (!pdw_within(&s.db, p, q, e))
+				continue;
+
+			++cnt;
+			if (s.db.visited[q] == CENTER && dbscan_stream_label(&s, q) == a)
+				near = 1;
+		}
+		core = cnt >= (int)minpts;
+
+		CHECK(s.count[p] == cnt);
+		CHECK((s.db.visited[p] == CENTER) == core);
+		CHECK((a < 0) == (b < 0));
+
+		if (a < 0) {
+			CHECK(s.db.visited[p] == NOISE);
+		} else if (core) {
+			CHECK(a <= (int)s.window && b <= (int)s.npts);
+			CHECK(map_s[a] == 0 || map_s[a] == b);
+			CHECK(map_d[b] == 0 || map_d[b] == a);
+			map_s[a] = b;
+			map_d[b] = a;
+		} else {
+			CHECK(s.db.visited[p] == EDGE && near);
+		}
+	}
+
+	CHECK(s.db.ngroup == db.ngroup);
+
+	/* 窗口外的槽 */
+	for (i = s.npts; i < (int)s.window; ++i) {
+		p = (s.head + i) % s.window;
+		CHECK(s.db.visited[p] == UNLABELED && dbscan_stream_label(&s, p) < 0);
+	}
+}
+
+static void push(const ORIG_PDW *pdw)
+{
+	int full = s.npts == s.window;
+	int p = rnd() & 1 ? dbscan_stream_slide(&s, pdw) : dbscan_stream_push(&s, pdw);
+
+	if (p < 0) {
+		CHECK(full);
+		return;
+	}
+
+	CHECK(p == (int)((s.head + s.npts - 1) % s.window));
+	win[p] = *pdw;
+}
+
+static void expire(void)
+{
+	int empty = s.npts == 0;
+	int head = s.head;
+	int x = dbscan_stream_expire(&s);
+
+	CHECK(empty ? x < 0 : x == head);
+}
+
+/* 漂移的辐射源加噪声 */
+static void run_drift(long steps)
+{
+	int ca[NEMITTER], cp[NEMITTER];
+	unsigned int peak = 0;
+	ORIG_PDW pdw;
+	int bias, k, op;
+
+	name = "drift";
+	e = 1u << 20;
+	minpts = 4;
+	CHECK(init_dbscan_stream(&s, WINDOW, e, minpts) == 0);
+
+	for (k = 0; k < NEMITTER; ++k) {
+		ca[k] = (int)(rnd() % (2 * AOA_BAND)) - (int)AOA_BAND;
+		cp[k] = PW_CENTER - PW_BAND + (int)(rnd() % (2 * PW_BAND));
+	}
+
+	for (step = 0; step < steps; ++step) {
+		/* 中心随机游走，限制在各自的范围内 */
+		for (k = 0; k < NEMITTER; ++k) {
+			ca[k] += (int)(rnd() % (2 * DRIFT + 1)) - (int)DRIFT;
+			cp[k] += (int)(rnd() % (2 * DRIFT + 1)) - (int)DRIFT;
+			if (ca[k] < -(int)AOA_BAND || ca[k] > (int)AOA_BAND)
+				ca[k] = 0;
+			if (cp[k] < (int)(PW_CENTER - PW_BAND) || cp[k] > (int)(PW_CENTER + PW_BAND))
+				cp[k] = PW_CENTER;
+		}
+
+		/* 256分之bias的概率加入 */
+		bias = (step / PHASE) & 1 ? 96 : 192;
+		op = rnd() & 255;
+
+		if (op < bias) {
+			k = rnd() % (NEMITTER + 1);
+			if (k == NEMITTER) {
+				pdw.AOA = around_aoa(0, AOA_BAND + (2u << 20));
+				pdw.PW = around_pw(PW_CENTER, PW_BAND + (2u << 20));
+			} else {
+				pdw.AOA = around_aoa(ca[k], 1u << 19);
+				pdw.PW = around_pw(cp[k], 1u << 18);
+			}
+			pdw.FC = 1000u << 20;
+			push(&pdw);
+		} else {
+			expire();
+		}
+
+		if (s.npts > peak)
+			peak = s.npts;
+		if (step % CMP_EVERY == 0)
+			compare();
+	}
+
+	compare();
+	del_dbscan_stream(&s);
+	printf("check_stream %s: %ld steps ok, peak %u points\n", name, steps, peak);
+}
+
+/* e=1时网格边长为1，pw接近UINT_MAX的点所在的行号接近UINT_MAX */
+static void run_edge(long steps)
+{
+	ORIG_PDW pdw;
+
+	name = "pw near UINT_MAX";
+	e = 1;
+	minpts = 3;
+	CHECK(init_dbscan_stream(&s, 64, e, minpts) == 0);
+
+	for (step = 0; step < steps; ++step) {
+		pdw.AOA = rnd() % 3;
+		pdw.PW = UINT_MAX - rnd() % 3;
+		pdw.FC = 1000u << 20;
+
+		if (rnd() % 4)
+			push(&pdw);
+		else
+			expire();
+		compare();
+	}
+
+	del_dbscan_stream(&s);
+	printf("check_stream %s: %ld steps ok\n", name, steps);
+}
+
+int main(int argc, char *argv[])
+{
+	long steps = argc > 1 ? atol(argv[1]) : 30000;
+
+	rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20240819;
+	if (!rng)
+		rng = 1;
+
+	if (init_dbscan(&db, WINDOW) < 0)
+		return 1;
+
+	run_drift(steps);
+	run_edge(steps / 20);
+
+	del_dbscan(&db);
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * check_ws_deque.c
+ *
+ *  ws_deque的并发检查: 所有者线程依次push N个不同的元素，随机地成批pop，
+ *  同时NTHIEF个窃取线程不停地steal. 队列大多时候只有几个元素，
+ *  最后一个元素上pop与steal的争抢很频繁. 结束后检查每个元素恰好被取走一次.
+ *  窃取者一直空转，单核时也常在steal中途被切换，能暴露CAS的错误，但运行较慢.
+ *  ASan/UBSan与TSan各编译一次，见Makefile的check目标.
+ *
+ *  编译(主机):
+ *      gcc -O1 -g -fsanitize=thread -I../deque -I../pool -o check_ws_deque \
+ *          check_ws_deque.c ../deque/ws_deque.c ../pool/pool.c -pthread
+ *  或make check
+ *
+ *  用法: ./check_ws_deque [元素个数] [随机种子]
+ */
+
+#include "ws_deque.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTHIEF   (3)
+#define BURST    (8)        /* 每次最多连续push的个数 */
+
+static struct ws_deque q;
+static atomic_uchar *taken;         /* 各元素被取走的次数 */
+static atomic_int done;
+static int n;
+
+struct thief {
+    pthread_t tid;
+    long nsteal;
+    long nabort;
+};
+
+static void take(int v)
+{
+    if (v < 0 || v >= n) {
+        printf("taken a value %d never pushed\n", v);
+        exit(1);
+    }
+    atomic_fetch_add_explicit(&taken[v], 1, memory_order_relaxed);
+}
+
+static void *steal_loop(void *arg)
+{
+    struct thief *t = (struct thief *)arg;
+    int v, ret;
+
+    for (;;) {
+        ret = ws_deque_steal(&q, &v);
+        if (ret == 0) {
+            take(v);
+            ++t->nsteal;
+        } else if (ret == WS_ABORT) {
+            ++t->nabort;
+        } else if (atomic_load_explicit(&done, memory_order_acquire)) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    struct thief th[NTHIEF];
+    unsigned int rng;
+    long npop = 0, nempty = 0, nsteal = 0, nabort = 0;
+    int i, k, v, next = 0, bad = 0;
+
+    n = argc > 1 ? atoi(argv[1]) : 100000;
+    rng = argc > 2 ? (unsigned int)strtoul(argv[2], NULL, 0) : 20241008;
+    if (n <= 0 || !rng)
+        return 1;
+
+    taken = (atomic_uchar *)calloc(n, sizeof(taken[0]));
+    if (!taken || ws_deque_init(&q) < 0)
+        return 1;
+
+    for (i = 0; i < NTHIEF; ++i) {
+        th[i].nsteal = th[i].nabort = 0;
+        if (pthread_create(&th[i].tid, NULL, steal_loop, &th[i]) != 0) {
+            printf("pthread_create failed.\n");
+            return 1;
+        }
+    }
+
+    while (next < n) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+
+        /* push 1~BURST个，满时先pop一个 */
+        for (k = 1 + rng % BURST; k > 0 && next < n; --k) {
+            if (ws_deque_push(&q, next) < 0) {
+                if (ws_deque_pop(&q, &v) == 0) {
+                    take(v);
+                    ++npop;
+                }
+                continue;
+            }
+            ++next;
+        }
+
+        /* 让窃取者有机会在队列非空时运行 */
+        if ((rng >> 24) < 16)
+            sched_yield();
+
+        /* pop 0~BURST个，常常把队列取空 */
+        for (k = (rng >> 8) % (BURST + 1); k > 0; --k) {
+            if (ws_deque_pop(&q, &v) != 0) {
+                ++nempty;
+                break;
+            }
+            take(v);
+            ++npop;
+        }
+    }
+
+    /* 所有者取走剩下的元素，之后窃取者看到空队列即退出 */
+    while (ws_deque_pop(&q, &v) == 0) {
+        take(v);
+        ++npop;
+    }
+    atomic_store_explicit(&done, 1, memory_order_release);
+
+    for (i = 0; i < NTHIEF; ++i) {
+        pthread_join(th[i].tid, NULL);
+        nsteal += th[i].nsteal;
+        nabort += th[i].nabort;
+    }
+
+    for (i = 0; i < n; ++i) {
+        if (atomic_load(&taken[i]) != 1) {
+            if (bad < 10)
+                printf("item %d taken %d times\n", i, (int)atomic_load(&taken[i]));
+            ++bad;
+        }
+    }
+
+    ws_deque_destroy(&q);
+    free(taken);
+
+    if (bad || npop + nsteal != n) {
+        printf("check_ws_deque: %d items wrong, %ld popped + %ld stolen of %d\n",
+                bad, npop, nsteal, n);
+        return 1;
+    }
+
+    printf("check_ws_deque: %d items ok, %ld popped, %ld stolen by %d thieves, "
+            "%ld empty pops, %ld aborted steals\n", n, npop, nsteal, NTHIEF, nempty, nabort);
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+/*
+ * dbscan_replay.c
+ *
+ *  离线回放PDW采集文件(见pdw_capture.h)，按给定参数重新聚类并写出结果.
+ *  三个线程流水处理:
+ *      读取线程  按顺序逐页访问映射中的下一帧，缺页在此线程中发生，帧号送入in_q;
+ *      聚类线程  attach_data()直接使用映射中的点(PDW_AOS时不拷贝)，
+ *                dbscan()后交给dbscan_async_sink，只拷贝结果，不等待I/O;
+ *      写出线程  dbscan_async_sink内部的线程，由bin或text sink格式化并写文件.
+ *  读取线程最多领先READ_AHEAD帧.
+ *
+ *  编译(主机):
+ *      gcc -O2 -pthread -Ihost -I../signal_proc/dbscan -I../deque -I../stack -I../pool \
+ *          -o dbscan_replay dbscan_replay.c pdw_gen.c ../signal_proc/dbscan/pdw_capture.c \
+ *          ../signal_proc/dbscan/dbscan_sink.c ../signal_proc/dbscan/dbscan_async.c \
+ *          ../signal_proc/dbscan/dbscan.c ../signal_proc/dbscan/nbr_index.c \
+ *          ../signal_proc/dbscan/nbr_kernel.c ../deque/deque.c ../pool/pool.c \
+ *          ../deque/spsc_deque.c
+ *  或make dbscan_replay DEFS="..."
+ *
+ *  用法:
+ *      ./dbscan_replay gen <采集文件> [帧数] [每帧点数]      用pdw_gen生成合成的采集文件
+ *      ./dbscan_replay run <采集文件> <结果文件> [e(度)] [minpts] [bin|summary|text]
+ *
+ *  结果文件: bin为各点的类编号，summary另加各类的统计，格式见dbscan_sink.h;
+ *            text与print_dbscan_result()相同.
+ */
+
+#include "dbscan.h"
+#include "dbscan_async.h"
+#include "pdw_capture.h"
+#include "pdw_gen.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define READ_AHEAD (64)		/* 读取线程最多领先的帧数 */
+#define PAGE_SIZE  (4096)
+#define END        (-1)		/* 队列中的结束标记 */
+
+static struct pdw_capture cap;
+static struct spsc_deque in_q;
+
+static double now_s(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void push(struct spsc_deque *q, int v)
+{
+	while (spsc_deque_push_back(q, v) < 0)
+		sched_yield();
+}
+
+static int pop(struct spsc_deque *q)
+{
+	int v;
+
+	while (spsc_deque_pop_front(q, &v) < 0)
+		sched_yield();
+
+	return v;
+}
+
+/* 逐页读[p, end)，使其在聚类线程用到之前已在内存中 */
+static void touch(const char *p, const char *end)
+{
+	p = cap.base + ((p - cap.base) & ~(size_t)(PAGE_SIZE - 1));
+	for (; p < end; p += PAGE_SIZE)
+		(void)*(const volatile char *)p;
+}
+
+static void *reader(void *arg)
+{
+	const struct pdw_cap_frame *f;
+	size_t pos = pdw_capture_begin(&cap), at;
+	pdw_st *set;
+	int seq = 0;
+
+	(void)arg;
+
+	for (at = pos; pdw_capture_next(&cap, &pos, &f, &set) > 0; at = pos) {
+		touch(cap.base + at, cap.base + pos);
+
+		while (spsc_deque_size(&in_q) >= READ_AHEAD)
+			sched_yield();
+		push(&in_q, seq++);
+	}
+
+	push(&in_q, END);
+
+	return NULL;
+}
+
+static int gen(const char *path, int nframe, int n)
+{
+	struct pdw_gen_cfg cfg = PDW_GEN_DEFAULT;
+	struct pdw_cap_writer w;
+	ORIG_PDW *frame;
+	int f;
+
+	frame = (ORIG_PDW *)malloc(sizeof(ORIG_PDW) * n);
+	if (!frame || pdw_capture_create(&w, path) < 0) {
+		free(frame);
+		return 1;
+	}
+
+	cfg.n = n;
+	for (f = 0; f < nframe; ++f) {
+		cfg.seed = 20240901 + f;
+		pdw_gen(&cfg, frame);
+		if (pdw_capture_append(&w, frame, n, (unsigned long long)f * 1000) < 0) {
+			printf("gen: write %s failed.\n", path);
+			break;
+		}
+	}
+
+	free(frame);
+	if (pdw_capture_finish(&w) < 0 || f < nframe)
+		return 1;
+
+	printf("%s: %d frames x %d pdw, %.1f MB\n", path, nframe, n,
+			(sizeof(struct pdw_cap_header) + nframe * pdw_cap_frame_bytes(n)) / 1e6);
+
+	return 0;
+}
+
+/* 按fmt打开结果文件，外面再套一层异步写出 */
+static struct dbscan_sink *open_sink(const char *result, const char *fmt)
+{
+	static struct dbscan_bin_sink bin;
+	static struct dbscan_text_sink text;
+	static struct dbscan_async_sink async;
+	struct dbscan_sink *next;
+
+	if (!strcmp(fmt, "text")) {
+		if (dbscan_text_sink_init(&text, result, 0) < 0)
+			return NULL;
+		next = &text.base;
+	} else {
+		if (dbscan_bin_sink_init(&bin, result, !strcmp(fmt, "summary")
+				? DBSCAN_BIN_LABELS | DBSCAN_BIN_SUMMARY : DBSCAN_BIN_LABELS, 0) < 0)
+			return NULL;
+		next = &bin.base;
+	}
+
+	if (dbscan_async_sink_init(&async, next, cap.hdr->max_npdw, 0, 0) < 0) {
+		dbscan_sink_close(next);
+		return NULL;
+	}
+
+	return &async.base;
+}
+
+/* 聚类线程: 与读取线程按相同顺序解析各帧，结果交给sink，返回后sink已关闭 */
+static int replay(dbscan_st *db, struct dbscan_sink *sink, const char *result,
+		unsigned int e, unsigned int minpts)
+{
+	const struct pdw_cap_frame *f;
+	pthread_t rt;
+	size_t pos;
+	pdw_st *set;
+	double t0, t1, busy = 0;
+	int nframe = 0, ret = 0;
+
+	t0 = now_s();
+	if (pthread_create(&rt, NULL, reader, NULL) != 0) {
+		printf("create reader thread failed.\n");
+		dbscan_sink_close(sink);
+		return 1;
+	}
+
+	pos = pdw_capture_begin(&cap);
+	while (pop(&in_q) != END) {
+		/* 读取线程已解析过，不会出错; 出错时仍取完in_q，避免读取线程阻塞 */
+		if (pdw_capture_next(&cap, &pos, &f, &set) <= 0) {
+			ret = 1;
+			continue;
+		}
+
+		/* 点数超过工作存储的帧跳过 */
+		if (reset_dbscan(db, f->npdw) < 0) {
+			printf("frame %u: skipped.\n", f->seq);
+			ret = 1;
+			continue;
+		}
+
+		t1 = now_s();
+
+		attach_data(db, set);
+#if DBSCAN_DEDUP
+		dbscan_dedup(db, 0);
+#endif
+		dbscan(db, e, minpts);
+		if (dbscan_sink_write(sink, db, f->seq) < 0)
+			ret = 1;
+
+		busy += now_s() - t1;
+		++nframe;
+	}
+
+	pthread_join(rt, NULL);
+	if (dbscan_sink_close(sink) < 0) {
+		printf("write %s failed.\n", result);
+		ret = 1;
+	}
+	t1 = now_s() - t0;
+
+	printf("%d frames, %llu pdw in %.3f s: %.2f Mpts/s, %.0f MB/s, clustering busy %.1f%%\n",
+			nframe, cap.hdr->npdw, t1, cap.hdr->npdw / t1 / 1e6,
+			cap.size / t1 / 1e6, 100 * busy / t1);
+
+	return ret;
+}
+
+/* 依次建立采集文件映射、in_q、dbscan_st和sink，任一步失败时释放已建立的 */
+static int run(const char *path, const char *result, unsigned int e, unsigned int minpts,
+		const char *fmt)
+{
+	struct dbscan_sink *sink;
+	dbscan_st db;
+	unsigned int num;
+	int ret = 1;
+
+	if (pdw_capture_open(&cap, path) < 0)
+		return 1;
+
+	num = cap.hdr->max_npdw;
+#if INIT_DBSCAN_MEASURE == STATIC_DBSCAN_MALLOC
+	/* 工作存储放不下的帧在replay()中跳过，不影响其他帧 */
+	if (num > DBSCAN_MAX_NUM)
+		num = DBSCAN_MAX_NUM;
+#endif
+
+	if (spsc_deque_init(&in_q) == 0) {
+		if (init_dbscan(&db, num) == 0) {
+			sink = open_sink(result, fmt);
+			if (sink)
+				ret = replay(&db, sink, result, e, minpts);
+		}
+		del_dbscan(&db);
+		spsc_deque_destroy(&in_q);
+	}
+
+	pdw_capture_close(&cap);
+
+	return ret;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc >= 3 && !strcmp(argv[1], "gen"))
+		return gen(argv[2], argc > 3 ? atoi(argv[3]) : 1000, argc > 4 ? atoi(argv[4]) : 4096);
+
+	if (argc >= 4 && !strcmp(argv[1], "run"))
+		return run(argv[2], argv[3],
+				(unsigned int)((argc > 4 ? atof(argv[4]) : 1.0) * (1u << 20)),
+				argc > 5 ? atoi(argv[5]) : 8, argc > 6 ? argv[6] : "bin");
+
+	printf("usage: %s gen <capture> [frames] [pdw per frame]\n"
+			"       %s run <capture> <result> [e(deg)] [minpts] [bin|summary|text]\n", argv[0], argv[0]);
+
+	return 1;
+}
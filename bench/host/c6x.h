@@ -0,0 +1,10 @@
+/*
+ * c6x.h
+ *
+ *  主机(x86/Linux)编译用的替身，代替TI编译器自带的c6x.h.
+ */
+
+#ifndef C6X_H_
+#define C6X_H_
+
+#endif /* C6X_H_ */
@@ -0,0 +1,16 @@
+/*
+ * srio_adapter.h
+ *
+ *  主机(x86/Linux)编译用的替身，只包含dbscan用到的ORIG_PDW字段.
+ */
+
+#ifndef SRIO_ADAPTER_H_
+#define SRIO_ADAPTER_H_
+
+typedef struct orig_pdw {
+	unsigned int AOA;		/* 12.20定点数 */
+	unsigned int FC;
+	unsigned int PW;
+}ORIG_PDW;
+
+#endif /* SRIO_ADAPTER_H_ */
@@ -0,0 +1,85 @@
+/*
+ * pdw_gen.c
+ *
+ *  合成PDW帧，见pdw_gen.h.
+ */
+
+#include "pdw_gen.h"
+
+#define AOA_RANGE  (360u << 20)		/* aoa: [0, 360)度 */
+#define PW_MIN     (1u << 20)		/* pw: [1, 100)us */
+#define PW_RANGE   (99u << 20)
+#define FREQ_MIN   (1000u << 20)	/* freq: [1000, 4000)MHz */
+#define FREQ_RANGE (3000u << 20)
+
+/* xorshift32，不依赖libc的rand() */
+static unsigned int next(unsigned int *s)
+{
+	unsigned int x = *s;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*s = x;
+
+	return x;
+}
+
+/* [0, 1) */
+static double uniform(unsigned int *s)
+{
+	return next(s) / 4294967296.0;
+}
+
+/* c附近[-spread, spread]的均匀抖动，不小于0 */
+static unsigned int jitter(unsigned int *s, unsigned int c, unsigned int spread)
+{
+	long long v = (long long)c + (long long)(next(s) % (2ull * spread + 1)) - spread;
+
+	return v < 0 ? 0 : (unsigned int)v;
+}
+
+void pdw_gen(const struct pdw_gen_cfg *cfg, ORIG_PDW *out)
+{
+	ORIG_PDW center[PDW_GEN_MAX_EMITTER];
+	int last[PDW_GEN_MAX_EMITTER];
+	unsigned int s = cfg->seed ? cfg->seed : 1;
+	int nem = cfg->nemitter;
+	int i, k;
+	long long a;
+
+	if (nem > PDW_GEN_MAX_EMITTER)
+		nem = PDW_GEN_MAX_EMITTER;
+
+	for (k = 0; k < nem; ++k) {
+		center[k].AOA = next(&s) % AOA_RANGE;
+		center[k].PW = PW_MIN + next(&s) % PW_RANGE;
+		center[k].FC = FREQ_MIN + next(&s) % FREQ_RANGE;
+		last[k] = -1;
+	}
+
+	for (i = 0; i < cfg->n; ++i) {
+		if (nem == 0 || uniform(&s) < cfg->noise) {
+			out[i].AOA = next(&s) % AOA_RANGE;
+			out[i].PW = PW_MIN + next(&s) % PW_RANGE;
+			out[i].FC = FREQ_MIN + next(&s) % FREQ_RANGE;
+			continue;
+		}
+
+		k = next(&s) % nem;
+
+		if (last[k] >= 0 && uniform(&s) < cfg->repeat) {
+			out[i] = out[last[k]];
+			continue;
+		}
+
+		/* aoa在周期内回绕 */
+		a = (long long)center[k].AOA + (long long)(next(&s) % (2ull * cfg->spread_aoa + 1))
+				- cfg->spread_aoa;
+		a %= AOA_RANGE;
+		out[i].AOA = (unsigned int)(a < 0 ? a + AOA_RANGE : a);
+		out[i].PW = jitter(&s, center[k].PW, cfg->spread_pw);
+		out[i].FC = jitter(&s, center[k].FC, cfg->spread_freq);
+		last[k] = i;
+	}
+}
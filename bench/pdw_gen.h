@@ -0,0 +1,43 @@
+/*
+ * pdw_gen.h
+ *
+ *  合成的PDW帧，供主机上的基准测试使用.
+ *  nemitter个辐射源的aoa/pw/freq中心随机选取，每个脉冲在中心附近均匀抖动;
+ *  noise比例的脉冲在整个范围内均匀分布;
+ *  repeat比例的脉冲与同一辐射源的上一个脉冲完全相同，用于测试重复点合并.
+ *  aoa在[0, 360)度内回绕，各参数均为12.20定点数.
+ */
+
+#ifndef PDW_GEN_H_
+#define PDW_GEN_H_
+
+#include "srio_adapter.h"
+
+struct pdw_gen_cfg {
+	int n;						/* 脉冲数 */
+	int nemitter;				/* 辐射源个数，最多PDW_GEN_MAX_EMITTER */
+	unsigned int spread_aoa;	/* 抖动的半宽 */
+	unsigned int spread_pw;
+	unsigned int spread_freq;
+	double noise;				/* 噪声脉冲的比例 */
+	double repeat;				/* 重复脉冲的比例 */
+	unsigned int seed;
+};
+
+#define PDW_GEN_MAX_EMITTER (256)
+
+#define PDW_GEN_DEFAULT { \
+	.n = 4096, \
+	.nemitter = 16, \
+	.spread_aoa = 1u << 20, \
+	.spread_pw = 1u << 19, \
+	.spread_freq = 1u << 20, \
+	.noise = 0.1, \
+	.repeat = 0.0, \
+	.seed = 20240901, \
+}
+
+/* 按cfg生成cfg->n个脉冲写入out，相同的cfg生成相同的帧 */
+void pdw_gen(const struct pdw_gen_cfg *cfg, ORIG_PDW *out);
+
+#endif /* PDW_GEN_H_ */
@@ -8,22 +8,21 @@
 #include "deque.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
-#define MAX_NUM (4096)
-#define DEQUE_NUM (8)
-static unsigned char buffer_map = 0;
+#define MAX_NUM DEQUE_MAX_NUM
 
 /* 申请了DEQUE_NUM个队列，每个队列最多有MAX_NUM元素 */
 #pragma DATA_SECTION(qdata_buffer, ".static_var")
 qdata qdata_buffer[DEQUE_NUM][MAX_NUM];
+static pool_word_t qdata_map[POOL_WORDS(DEQUE_NUM)];
+static struct pool qdata_pool = POOL_INIT(qdata_buffer, qdata_map, DEQUE_NUM, sizeof(qdata_buffer[0]));
 #endif
 
 static int init(struct deque *q);
-static inline int push_back(struct deque *q, qdata d);
-static inline int pop_front(struct deque *q, qdata *to);
-static inline int front(struct deque *q, qdata *to);
-static inline void clear(struct deque *q);
+static inline int reserve(struct deque *q, int n);
+static inline void shrink(struct deque *q);
 static void destroy(struct deque *q);
 
 int deque_init(struct deque *q)
@@ -43,12 +42,31 @@ int deque_push_back(struct deque *q, qdata d)
         return -1;
     }
 
-    if (q->capacity >= MAX_NUM) {
+    if (reserve(q, 1) < 0) {
         printf("push_back: deque buffer is full.\n");
         return -2;
     }
 
-    return push_back(q, d);
+    deque_push_back_fast(q, d);
+
+    return 0;
+}
+
+int deque_push_front(struct deque *q, qdata d)
+{
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return -1;
+    }
+
+    if (reserve(q, 1) < 0) {
+        printf("push_front: deque buffer is full.\n");
+        return -2;
+    }
+
+    deque_push_front_fast(q, d);
+
+    return 0;
 }
 
 int deque_pop_front(struct deque *q, qdata *to)
@@ -63,7 +81,28 @@ int deque_pop_front(struct deque *q, qdata *to)
         return -2;
     }
 
-    return pop_front(q, to);
+    *to = deque_pop_front_fast(q);
+    shrink(q);
+
+    return 0;
+}
+
+int deque_pop_back(struct deque *q, qdata *to)
+{
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return -1;
+    }
+
+    if (q->capacity <= 0) {
+        printf("pop_back: deque buffer is empty.\n");
+        return -2;
+    }
+
+    *to = deque_pop_back_fast(q);
+    shrink(q);
+
+    return 0;
 }
 
 int deque_front(struct deque *q, qdata *to)
@@ -78,7 +117,104 @@ int deque_front(struct deque *q, qdata *to)
         return -2;
     }
 
-    return front(q, to);
+    *to = deque_front_fast(q);
+
+    return 0;
+}
+
+int deque_back(struct deque *q, qdata *to)
+{
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return -1;
+    }
+
+    if (q->capacity <= 0) {
+        printf("back: deque buffer is empty.\n");
+        return -2;
+    }
+
+    *to = deque_back_fast(q);
+
+    return 0;
+}
+
+int deque_at(struct deque *q, int i, qdata *to)
+{
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return -1;
+    }
+
+    if (i < 0 || i >= q->capacity) {
+        printf("at: index %d out of range.\n", i);
+        return -2;
+    }
+
+    *to = deque_at_fast(q, i);
+
+    return 0;
+}
+
+int deque_push_back_n(struct deque *q, const qdata *src, int n)
+{
+    int first, n1;
+
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return -1;
+    }
+
+    if (n <= 0)
+        return 0;
+
+    if (reserve(q, n) < 0) {
+        printf("push_back_n: deque buffer is full.\n");
+        return -2;
+    }
+
+    /* 从tail之后开始放，到缓冲区末尾时回绕，最多两次memcpy */
+    first = (q->tail + 1) & DEQUE_MASK(q);
+    n1 = DEQUE_MASK(q) + 1 - first;
+    if (n1 > n)
+        n1 = n;
+
+    memcpy(q->data + first, src, sizeof(qdata) * n1);
+    memcpy(q->data, src + n1, sizeof(qdata) * (n - n1));
+
+    q->tail = (q->tail + n) & DEQUE_MASK(q);
+    q->capacity += n;
+
+    return 0;
+}
+
+int deque_pop_front_n(struct deque *q, qdata *to, int n)
+{
+    int first, n1;
+
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return -1;
+    }
+
+    if (n > q->capacity)
+        n = q->capacity;
+    if (n <= 0)
+        return 0;
+
+    first = (q->front + 1) & DEQUE_MASK(q);
+    n1 = DEQUE_MASK(q) + 1 - first;
+    if (n1 > n)
+        n1 = n;
+
+    memcpy(to, q->data + first, sizeof(qdata) * n1);
+    memcpy(to + n1, q->data, sizeof(qdata) * (n - n1));
+
+    q->front = (q->front + n) & DEQUE_MASK(q);
+    q->capacity -= n;
+    shrink(q);
+
+    return n;
 }
 
 void deque_clear(struct deque *q)
@@ -88,7 +224,8 @@ void deque_clear(struct deque *q)
         return;
     }
 
-    clear(q);
+    q->capacity = 0;
+    q->front = q->tail = DEQUE_MASK(q);
 }
 
 void deque_destroy(struct deque *q)
@@ -105,76 +242,112 @@ void deque_destroy(struct deque *q)
 
 static int init(struct deque *q)
 {
-    int i;
-    int length = sizeof(buffer_map) * 8;
-
-    /* 寻找未被使用的队列，buffer_map的第i位是0，则表示第i个队列尚未被使用 */
-    for (i = 0; i < length; ++i) {
-        if (!(buffer_map & (1 << i)))
-            break;
-    }
-
-    if (i == length) {
+    q->data = (qdata *)pool_alloc(&qdata_pool);
+    if (!q->data) {
         printf("Init: deque is full.\n");
         return -2;
     }
 
-    /* buffer_map的第i位置1，占用第i个队列 */
-    buffer_map |= (1 << i);
-    q->data = qdata_buffer[i];
     q->capacity = 0;
-    q->front = -1;
-    q->tail = -1;
+    q->front = q->tail = DEQUE_MASK(q);
 
     return 0;
 }
 
-static inline int push_back(struct deque *q, qdata d)
+/* 能否再放入n个元素 */
+static inline int reserve(struct deque *q, int n)
 {
-    ++q->capacity;
-    q->tail = (q->tail + 1) % MAX_NUM;
-    q->data[q->tail] = d;
+    return q->capacity + n <= MAX_NUM ? 0 : -1;
+}
 
-    return 0;
+static inline void shrink(struct deque *q)
+{
+    (void)q;
 }
 
-static inline int pop_front(struct deque *q, qdata *to)
+static void destroy(struct deque *q)
 {
-    --q->capacity;
-    q->front = (q->front + 1) % MAX_NUM;
-    *to = q->data[q->front];
+    pool_free(&qdata_pool, q->data);
+    q->data = NULL;
+}
 
-    return 0;
+void deque_pool_stats(struct pool_stats *s)
+{
+    pool_get_stats(&qdata_pool, s);
 }
+#endif
+
+#if INIT_DEQUE_MEASURE == DYNAMIC_DEQUE_MALLOC
 
-static inline int front(struct deque *q, qdata *to)
+static int init(struct deque *q)
 {
-    int pos;
+    q->data = (qdata *)malloc(sizeof(qdata) * DEQUE_MIN_SIZE);
+    if (!q->data) {
+        printf("Init: deque malloc failed.\n");
+        return -2;
+    }
 
-    pos = (q->front + 1) % MAX_NUM;
-    *to = q->data[pos];
+    q->mask = DEQUE_MIN_SIZE - 1;
+    q->capacity = 0;
+    q->front = q->tail = q->mask;
 
     return 0;
 }
 
-static inline void clear(struct deque *q)
+/* 换成长度为size的缓冲区，元素按顺序搬到开头，最多两次memcpy */
+static int resize(struct deque *q, int size)
 {
-    q->capacity = 0;
-    q->front = q->tail = -1;
+    qdata *data = (qdata *)malloc(sizeof(qdata) * size);
+    int first, n;
+
+    if (!data)
+        return -1;
+
+    first = (q->front + 1) & q->mask;
+    n = q->mask + 1 - first;
+    if (n > q->capacity)
+        n = q->capacity;
+
+    memcpy(data, q->data + first, sizeof(qdata) * n);
+    memcpy(data + n, q->data, sizeof(qdata) * (q->capacity - n));
+    free(q->data);
+
+    q->data = data;
+    q->mask = size - 1;
+    q->front = q->mask;
+    q->tail = (q->capacity - 1) & q->mask;
+
+    return 0;
 }
 
-static void destroy(struct deque *q)
+/* 空间不足时加倍，直到能再放入n个元素 */
+static inline int reserve(struct deque *q, int n)
 {
-    int i;
-    int length = sizeof(buffer_map) * 8;
+    int size = q->mask + 1;
 
-    /* 找到队列使用的buffer i，把buffer_map的第i位置零 */
-    for (i = 0; i < length; ++i) {
-        if (q->data == qdata_buffer[i]) {
-            buffer_map &= ~(1 << i);
-        }
-    }
+    if (q->capacity + n <= size)
+        return 0;
 
+    while (q->capacity + n > size)
+        size *= 2;
+
+    return resize(q, size);
+}
+
+/* 先取出再减半，减半失败时保持原缓冲区 */
+static inline void shrink(struct deque *q)
+{
+#if DEQUE_SHRINK
+    if (q->mask >= DEQUE_MIN_SIZE && q->capacity <= (q->mask + 1) / 4)
+        resize(q, (q->mask + 1) / 2);
+#else
+    (void)q;
+#endif
+}
+
+static void destroy(struct deque *q)
+{
+    free(q->data);
     q->data = NULL;
 }
 #endif
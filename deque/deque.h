@@ -13,43 +13,120 @@
 #define STATIC_DEQUE_MALLOC 1
 #define DYNAMIC_DEQUE_MALLOC 2
 
+/*
+ * STATIC_DEQUE_MALLOC  从静态槽池的DEQUE_NUM个缓冲区中分配，每个队列最多DEQUE_MAX_NUM个元素;
+ * DYNAMIC_DEQUE_MALLOC 堆上的环形缓冲区，长度为2的幂，满时加倍，
+ *                      DEQUE_SHRINK为1时元素数降到长度的1/4以下则减半.
+ * 两种模式下下标都用掩码回绕，不做除法.
+ */
+#ifndef INIT_DEQUE_MEASURE
 #define INIT_DEQUE_MEASURE STATIC_DEQUE_MALLOC
+#endif
 
-typedef int deque_element_type;
+#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
+#include "pool.h"
+
+#ifndef DEQUE_NUM
+#define DEQUE_NUM (8)           /* 队列个数 */
+#endif
+#ifndef DEQUE_MAX_NUM
+#define DEQUE_MAX_NUM (4096)    /* 每个队列的元素个数，必须是2的幂 */
+#endif
+#define DEQUE_MASK(q) (DEQUE_MAX_NUM - 1)
+#endif
 
 #if INIT_DEQUE_MEASURE == DYNAMIC_DEQUE_MALLOC
-typedef struct deque_data {
-    deque_element_type val;
-    struct deque_data *pre;
-    struct deque_data *next;
-}qdata;
+#define DEQUE_MASK(q) ((q)->mask)
+#define DEQUE_MIN_SIZE (64)     /* 初始长度，必须是2的幂 */
+#ifndef DEQUE_SHRINK
+#define DEQUE_SHRINK 0
+#endif
 #endif
 
-#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
+typedef int deque_element_type;
 typedef deque_element_type qdata;
-#endif
 
 struct deque {
     int capacity;    /* 队列中元素的数量 */
+    qdata *data;
+    int front;       /* 头指针，指向第一个元素的前一个位置 */
+    int tail;        /* 尾指针，指向最后一个元素 */
 
 #if INIT_DEQUE_MEASURE == DYNAMIC_DEQUE_MALLOC
-    qdata *front;    /* 头指针 */
-    qdata *tail;     /* 尾指针 */
-#endif
-
-#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
-    qdata *data;
-    int front;       /* 头指针 */
-    int tail;        /* 尾指针 */
+    int mask;        /* 缓冲区长度减1 */
 #endif
 };
 
 int deque_init(struct deque *q);
 int deque_push_back(struct deque *q, qdata d);
+int deque_push_front(struct deque *q, qdata d);
 int deque_pop_front(struct deque *q, qdata *to);
+int deque_pop_back(struct deque *q, qdata *to);
 int deque_front(struct deque *q, qdata *to);
+int deque_back(struct deque *q, qdata *to);
+int deque_at(struct deque *q, int i, qdata *to);    /* 第i个元素，0为队头 */
+
+/* 放入n个元素，空间不足时一个也不放入；取出最多n个元素，返回取出的个数 */
+int deque_push_back_n(struct deque *q, const qdata *src, int n);
+int deque_pop_front_n(struct deque *q, qdata *to, int n);
+
 void deque_clear(struct deque *q);
 
+/*
+ * 不做检查的快速版本，调用者须保证队列已初始化，
+ * 放入时有空间(DYNAMIC模式下不会扩容)，取出时非空.
+ */
+static inline void deque_push_back_fast(struct deque *q, qdata d)
+{
+    ++q->capacity;
+    q->tail = (q->tail + 1) & DEQUE_MASK(q);
+    q->data[q->tail] = d;
+}
+
+static inline void deque_push_front_fast(struct deque *q, qdata d)
+{
+    ++q->capacity;
+    q->data[q->front] = d;
+    q->front = (q->front - 1) & DEQUE_MASK(q);
+}
+
+static inline qdata deque_pop_front_fast(struct deque *q)
+{
+    --q->capacity;
+    q->front = (q->front + 1) & DEQUE_MASK(q);
+    return q->data[q->front];
+}
+
+static inline qdata deque_pop_back_fast(struct deque *q)
+{
+    qdata d = q->data[q->tail];
+
+    --q->capacity;
+    q->tail = (q->tail - 1) & DEQUE_MASK(q);
+    return d;
+}
+
+static inline qdata deque_front_fast(struct deque *q)
+{
+    return q->data[(q->front + 1) & DEQUE_MASK(q)];
+}
+
+static inline qdata deque_back_fast(struct deque *q)
+{
+    return q->data[q->tail];
+}
+
+static inline qdata deque_at_fast(struct deque *q, int i)
+{
+    return q->data[(q->front + 1 + i) & DEQUE_MASK(q)];
+}
+
+/* 剩余空间，DYNAMIC模式下为扩容前的空间 */
+static inline int deque_room(struct deque *q)
+{
+    return DEQUE_MASK(q) + 1 - q->capacity;
+}
+
 static inline bool deque_empty(struct deque *q)
 {
     if (!q)
@@ -68,4 +145,9 @@ static inline int deque_size(struct deque *q)
 
 void deque_destroy(struct deque *q);
 
+#if INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC
+/* 静态缓冲区的占用情况 */
+void deque_pool_stats(struct pool_stats *s);
+#endif
+
 #endif /* _DEQUE_H_ */
@@ -0,0 +1,313 @@
+/*
+ * deque.hpp
+ *
+ *  Created on: 2024年9月30日
+ *      Author: xdu903
+ */
+
+#ifndef _DEQUE_HPP_
+#define _DEQUE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/*
+ * 与deque.c相同的环形队列，元素类型为模板参数.
+ *     static_deque<T, N>      存储在对象内，N必须是2的幂，满时push返回false;
+ *     ring_deque<T, Alloc>    由分配器申请，长度为2的幂，满时加倍.
+ * 元素原地构造、析构，可以存放只能移动的类型; 全部函数都在头文件中，可以完全内联.
+ * C接口(struct deque)保持不变，deque_int即对应的int实例.
+ */
+namespace ctl {
+
+namespace detail {
+
+constexpr bool is_pow2(std::size_t n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+/*
+ * 环形队列的公共操作，Derived提供data()、mask()、full()和grow_emplace().
+ * head为第一个元素的下标，count为元素个数.
+ */
+template <class T, class Derived>
+class ring_ops {
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    size_type size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    T &front() { return *slot(0); }
+    const T &front() const { return *slot(0); }
+    T &back() { return *slot(count_ - 1); }
+    const T &back() const { return *slot(count_ - 1); }
+    T &operator[](size_type i) { return *slot(i); }
+    const T &operator[](size_type i) const { return *slot(i); }
+
+    /* 满时由grow_emplace扩容并构造新元素 */
+    template <class... Args>
+    bool emplace_back(Args &&...args)
+    {
+        if (self().full())
+            return self().grow_emplace(false, std::forward<Args>(args)...);
+
+        ::new (static_cast<void *>(slot(count_))) T(std::forward<Args>(args)...);
+        ++count_;
+        return true;
+    }
+
+    template <class... Args>
+    bool emplace_front(Args &&...args)
+    {
+        if (self().full())
+            return self().grow_emplace(true, std::forward<Args>(args)...);
+
+        size_type h = (head_ - 1) & self().mask();
+        ::new (static_cast<void *>(self().data() + h)) T(std::forward<Args>(args)...);
+        head_ = h;
+        ++count_;
+        return true;
+    }
+
+    bool push_back(const T &v) { return emplace_back(v); }
+    bool push_back(T &&v) { return emplace_back(std::move(v)); }
+    bool push_front(const T &v) { return emplace_front(v); }
+    bool push_front(T &&v) { return emplace_front(std::move(v)); }
+
+    /* 调用者须保证非空 */
+    void pop_front()
+    {
+        slot(0)->~T();
+        head_ = (head_ + 1) & self().mask();
+        --count_;
+    }
+
+    void pop_back()
+    {
+        slot(count_ - 1)->~T();
+        --count_;
+    }
+
+    bool try_pop_front(T &to)
+    {
+        if (count_ == 0)
+            return false;
+
+        to = std::move(front());
+        pop_front();
+        return true;
+    }
+
+    bool try_pop_back(T &to)
+    {
+        if (count_ == 0)
+            return false;
+
+        to = std::move(back());
+        pop_back();
+        return true;
+    }
+
+    void clear()
+    {
+        while (count_)
+            pop_back();
+        head_ = 0;
+    }
+
+protected:
+    ring_ops() : head_(0), count_(0) {}
+
+    T *slot(size_type i) { return self().data() + ((head_ + i) & self().mask()); }
+    const T *slot(size_type i) const { return self().data() + ((head_ + i) & self().mask()); }
+
+    size_type head_;
+    size_type count_;
+
+private:
+    Derived &self() { return *static_cast<Derived *>(this); }
+    const Derived &self() const { return *static_cast<const Derived *>(this); }
+};
+
+} /* namespace detail */
+
+template <class T, std::size_t N>
+class static_deque : public detail::ring_ops<T, static_deque<T, N> > {
+    static_assert(detail::is_pow2(N), "static_deque: N must be a power of two");
+
+    friend class detail::ring_ops<T, static_deque<T, N> >;
+
+public:
+    static constexpr std::size_t capacity() { return N; }
+
+    static_deque() {}
+    ~static_deque() { this->clear(); }
+
+    static_deque(const static_deque &) = delete;
+    static_deque &operator=(const static_deque &) = delete;
+
+    bool full() const { return this->count_ == N; }
+
+private:
+    T *data() { return reinterpret_cast<T *>(buf_); }
+    const T *data() const { return reinterpret_cast<const T *>(buf_); }
+    static constexpr std::size_t mask() { return N - 1; }
+
+    template <class... Args>
+    static constexpr bool grow_emplace(bool, Args &&...) { return false; }
+
+    alignas(T) unsigned char buf_[sizeof(T) * N];
+};
+
+template <class T, class Alloc = std::allocator<T> >
+class ring_deque : public detail::ring_ops<T, ring_deque<T, Alloc> > {
+    typedef std::allocator_traits<Alloc> traits;
+    friend class detail::ring_ops<T, ring_deque<T, Alloc> >;
+
+public:
+    static constexpr std::size_t min_size = 64;
+
+    explicit ring_deque(const Alloc &a = Alloc()) : alloc_(a), data_(nullptr), mask_(0) {}
+
+    ~ring_deque()
+    {
+        this->clear();
+        if (data_)
+            traits::deallocate(alloc_, data_, mask_ + 1);
+    }
+
+    ring_deque(const ring_deque &) = delete;
+    ring_deque &operator=(const ring_deque &) = delete;
+
+    ring_deque(ring_deque &&o) noexcept : alloc_(std::move(o.alloc_)), data_(o.data_), mask_(o.mask_)
+    {
+        this->head_ = o.head_;
+        this->count_ = o.count_;
+        o.data_ = nullptr;
+        o.mask_ = 0;
+        o.head_ = o.count_ = 0;
+    }
+
+    /* 先释放自己的元素和缓冲区，再接管o的 */
+    ring_deque &operator=(ring_deque &&o) noexcept
+    {
+        if (this == &o)
+            return *this;
+
+        this->clear();
+        if (data_)
+            traits::deallocate(alloc_, data_, mask_ + 1);
+
+        alloc_ = std::move(o.alloc_);
+        data_ = o.data_;
+        mask_ = o.mask_;
+        this->head_ = o.head_;
+        this->count_ = o.count_;
+        o.data_ = nullptr;
+        o.mask_ = 0;
+        o.head_ = o.count_ = 0;
+        return *this;
+    }
+
+    std::size_t capacity() const { return data_ ? mask_ + 1 : 0; }
+    bool full() const { return this->count_ == capacity(); }
+
+    /* 预留至少n个元素的空间 */
+    bool reserve(std::size_t n)
+    {
+        std::size_t size = capacity() ? capacity() : min_size;
+
+        while (size < n)
+            size *= 2;
+
+        return size == capacity() || resize(size);
+    }
+
+private:
+    T *data() { return data_; }
+    const T *data() const { return data_; }
+    std::size_t mask() const { return mask_; }
+
+    /*
+     * 加倍并在新缓冲区中构造新元素(front为真时放在队首)，之后才移动旧元素:
+     * args可能引用队列中的元素，如d.push_back(d.front())，旧缓冲区此时仍然有效.
+     */
+    template <class... Args>
+    bool grow_emplace(bool front, Args &&...args)
+    {
+        std::size_t size = data_ ? (mask_ + 1) * 2 : min_size;
+        std::size_t at = front ? size - 1 : this->count_;
+        buffer buf(alloc_, size);
+
+        if (!buf.data)
+            return false;
+
+        ::new (static_cast<void *>(buf.data + at)) T(std::forward<Args>(args)...);
+        relocate(buf);
+        if (front)
+            this->head_ = at;
+        ++this->count_;
+        return true;
+    }
+
+    bool resize(std::size_t size)
+    {
+        buffer buf(alloc_, size);
+
+        if (!buf.data)
+            return false;
+
+        relocate(buf);
+        return true;
+    }
+
+    /* 新申请的缓冲区，构造新元素抛出异常时由析构函数释放 */
+    struct buffer {
+        buffer(Alloc &a, std::size_t n) : alloc(a), data(traits::allocate(a, n)), size(n) {}
+        ~buffer()
+        {
+            if (data)
+                traits::deallocate(alloc, data, size);
+        }
+
+        Alloc &alloc;
+        T *data;    /* std::allocator失败时抛出异常，嵌入式分配器可以返回空指针 */
+        std::size_t size;
+    };
+
+    /* 元素按顺序移动到新缓冲区的开头，释放旧缓冲区，buf交给队列 */
+    void relocate(buffer &buf)
+    {
+        std::size_t i;
+
+        for (i = 0; i < this->count_; ++i) {
+            T *p = this->slot(i);
+            ::new (static_cast<void *>(buf.data + i)) T(std::move(*p));
+            p->~T();
+        }
+
+        if (data_)
+            traits::deallocate(alloc_, data_, mask_ + 1);
+
+        data_ = buf.data;
+        mask_ = buf.size - 1;
+        this->head_ = 0;
+        buf.data = nullptr;
+    }
+
+    Alloc alloc_;
+    T *data_;
+    std::size_t mask_;
+};
+
+/* 与C接口struct deque(STATIC模式)对应的int实例 */
+typedef static_deque<int, 4096> deque_int;
+
+} /* namespace ctl */
+
+#endif /* _DEQUE_HPP_ */
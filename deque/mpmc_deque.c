@@ -0,0 +1,177 @@
+/*
+ * mpmc_deque.c
+ *
+ *  Created on: 2024年9月9日
+ *      Author: xdu903
+ */
+
+#include "mpmc_deque.h"
+#include <stdio.h>
+
+/* 申请了MPMC_DEQUE_NUM个队列，每个队列最多有MPMC_MAX_NUM元素 */
+#pragma DATA_SECTION(mpmc_buffer, ".static_var")
+static struct mpmc_cell mpmc_buffer[MPMC_DEQUE_NUM][MPMC_MAX_NUM];
+static pool_word_t mpmc_map[POOL_WORDS(MPMC_DEQUE_NUM)];
+static struct pool mpmc_pool = POOL_INIT(mpmc_buffer, mpmc_map, MPMC_DEQUE_NUM, sizeof(mpmc_buffer[0]));
+
+int mpmc_deque_init(struct mpmc_deque *q)
+{
+    int i;
+
+    if (!q) {
+        printf("Queue not exist\n");
+        return -1;
+    }
+
+    q->cell = (struct mpmc_cell *)pool_alloc(&mpmc_pool);
+    if (!q->cell) {
+        printf("Init: mpmc deque is full.\n");
+        return -2;
+    }
+
+    q->mask = MPMC_MAX_NUM - 1;
+
+    for (i = 0; i < MPMC_MAX_NUM; ++i)
+        atomic_init(&q->cell[i].seq, i);
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+
+    return 0;
+}
+
+/*
+ * 从pos开始最多n个位置中，seq等于pos + i + off的连续位置数.
+ * 放入时off为0(空闲)，取出时off为1(已放入).
+ */
+static inline unsigned int ready(struct mpmc_deque *q, unsigned int pos,
+        unsigned int n, unsigned int off)
+{
+    unsigned int i;
+
+    for (i = 0; i < n; ++i) {
+        if (atomic_load_explicit(&q->cell[(pos + i) & q->mask].seq,
+                memory_order_acquire) != pos + i + off)
+            break;
+    }
+
+    return i;
+}
+
+/*
+ * 领取[pos, pos + k)，返回k，k为0表示队列满(off为0)或空(off为1).
+ * 第一个位置的seq落后于pos说明这一圈还没轮到，超前说明别的线程已领取，重读idx.
+ */
+static unsigned int claim(struct mpmc_deque *q, atomic_uint *idx,
+        unsigned int n, unsigned int off, unsigned int *at)
+{
+    unsigned int pos = atomic_load_explicit(idx, memory_order_relaxed);
+    unsigned int seq, k;
+    int dif;
+
+    for (;;) {
+        seq = atomic_load_explicit(&q->cell[pos & q->mask].seq, memory_order_acquire);
+        dif = (int)(seq - (pos + off));
+
+        if (dif < 0)
+            return 0;
+
+        if (dif > 0) {
+            pos = atomic_load_explicit(idx, memory_order_relaxed);
+            continue;
+        }
+
+        k = ready(q, pos, n, off);
+        if (atomic_compare_exchange_weak_explicit(idx, &pos, pos + k,
+                memory_order_relaxed, memory_order_relaxed)) {
+            *at = pos;
+            return k;
+        }
+    }
+}
+
+int mpmc_deque_try_push_back(struct mpmc_deque *q, deque_element_type d)
+{
+    unsigned int pos;
+    struct mpmc_cell *c;
+
+    if (!claim(q, &q->tail, 1, 0, &pos))
+        return -2;
+
+    c = &q->cell[pos & q->mask];
+    c->val = d;
+    atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+
+    return 0;
+}
+
+int mpmc_deque_try_pop_front(struct mpmc_deque *q, deque_element_type *to)
+{
+    unsigned int pos;
+    struct mpmc_cell *c;
+
+    if (!claim(q, &q->head, 1, 1, &pos))
+        return -2;
+
+    c = &q->cell[pos & q->mask];
+    *to = c->val;
+
+    /* 下一圈的生产者可以使用这个位置 */
+    atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release);
+
+    return 0;
+}
+
+int mpmc_deque_push_back_n(struct mpmc_deque *q, const deque_element_type *src, int n)
+{
+    unsigned int pos, k, i;
+    struct mpmc_cell *c;
+
+    if (n <= 0)
+        return 0;
+
+    k = claim(q, &q->tail, n, 0, &pos);
+
+    for (i = 0; i < k; ++i) {
+        c = &q->cell[(pos + i) & q->mask];
+        c->val = src[i];
+        atomic_store_explicit(&c->seq, pos + i + 1, memory_order_release);
+    }
+
+    return k;
+}
+
+int mpmc_deque_pop_front_n(struct mpmc_deque *q, deque_element_type *to, int n)
+{
+    unsigned int pos, k, i;
+    struct mpmc_cell *c;
+
+    if (n <= 0)
+        return 0;
+
+    k = claim(q, &q->head, n, 1, &pos);
+
+    for (i = 0; i < k; ++i) {
+        c = &q->cell[(pos + i) & q->mask];
+        to[i] = c->val;
+        atomic_store_explicit(&c->seq, pos + i + q->mask + 1, memory_order_release);
+    }
+
+    return k;
+}
+
+void mpmc_deque_destroy(struct mpmc_deque *q)
+{
+    if (!q || !q->cell) {
+        printf("Queue is not initialized\n");
+        return;
+    }
+
+    pool_free(&mpmc_pool, q->cell);
+    q->cell = NULL;
+}
+
+void mpmc_deque_pool_stats(struct pool_stats *s)
+{
+    pool_get_stats(&mpmc_pool, s);
+}
@@ -0,0 +1,65 @@
+/*
+ * mpmc_deque.h
+ *
+ *  Created on: 2024年9月9日
+ *      Author: xdu903
+ */
+
+#ifndef _MPMC_DEQUE_H_
+#define _MPMC_DEQUE_H_
+
+#include "deque.h"
+#include "pool.h"
+#include <stdatomic.h>
+
+#define MPMC_CACHE_LINE (64)
+
+#ifndef MPMC_DEQUE_NUM
+#define MPMC_DEQUE_NUM (8)          /* 队列个数 */
+#endif
+#ifndef MPMC_MAX_NUM
+#define MPMC_MAX_NUM (4096)         /* 每个队列的元素个数，必须是2的幂 */
+#endif
+
+/*
+ * 多生产者/多消费者有界队列(Vyukov).
+ * 每个位置带一个序号seq:
+ *     seq == pos      位置空闲，可以放入第pos个元素;
+ *     seq == pos + 1  第pos个元素已放入，可以取出.
+ * 生产者、消费者分别用CAS领取tail、head，领取后各自读写，互不阻塞.
+ */
+struct mpmc_cell {
+    atomic_uint seq;
+    deque_element_type val;
+};
+
+struct mpmc_deque {
+    _Alignas(MPMC_CACHE_LINE) atomic_uint tail;
+    _Alignas(MPMC_CACHE_LINE) atomic_uint head;
+    _Alignas(MPMC_CACHE_LINE) struct mpmc_cell *cell;
+    unsigned int mask;
+};
+
+int mpmc_deque_init(struct mpmc_deque *q);
+
+/* 队列满或空时立即返回-2 */
+int mpmc_deque_try_push_back(struct mpmc_deque *q, deque_element_type d);
+int mpmc_deque_try_pop_front(struct mpmc_deque *q, deque_element_type *to);
+
+/* 一次领取连续的多个位置，返回实际放入/取出的个数 */
+int mpmc_deque_push_back_n(struct mpmc_deque *q, const deque_element_type *src, int n);
+int mpmc_deque_pop_front_n(struct mpmc_deque *q, deque_element_type *to, int n);
+
+/* 并发时只是近似值 */
+static inline int mpmc_deque_size(struct mpmc_deque *q)
+{
+    return (int)(atomic_load_explicit(&q->tail, memory_order_relaxed)
+            - atomic_load_explicit(&q->head, memory_order_relaxed));
+}
+
+void mpmc_deque_destroy(struct mpmc_deque *q);
+
+/* 静态缓冲区的占用情况 */
+void mpmc_deque_pool_stats(struct pool_stats *s);
+
+#endif /* _MPMC_DEQUE_H_ */
@@ -0,0 +1,162 @@
+/*
+ * spsc_deque.c
+ *
+ *  Created on: 2024年9月2日
+ *      Author: xdu903
+ */
+
+#include "spsc_deque.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 申请了SPSC_DEQUE_NUM个队列，每个队列最多有SPSC_MAX_NUM元素 */
+#pragma DATA_SECTION(spsc_buffer, ".static_var")
+static deque_element_type spsc_buffer[SPSC_DEQUE_NUM][SPSC_MAX_NUM];
+static pool_word_t spsc_map[POOL_WORDS(SPSC_DEQUE_NUM)];
+static struct pool spsc_pool = POOL_INIT(spsc_buffer, spsc_map, SPSC_DEQUE_NUM, sizeof(spsc_buffer[0]));
+
+int spsc_deque_init(struct spsc_deque *q)
+{
+    if (!q) {
+        printf("Queue not exist\n");
+        return -1;
+    }
+
+    q->data = (deque_element_type *)pool_alloc(&spsc_pool);
+    if (!q->data) {
+        printf("Init: spsc deque is full.\n");
+        return -2;
+    }
+
+    q->mask = SPSC_MAX_NUM - 1;
+    q->head_cache = 0;
+    q->tail_cache = 0;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+
+    return 0;
+}
+
+/* 生产者: 剩余空间不足n时才重新读取head */
+static inline unsigned int free_space(struct spsc_deque *q, unsigned int tail, unsigned int n)
+{
+    unsigned int space = q->mask + 1 - (tail - q->head_cache);
+
+    if (space < n) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        space = q->mask + 1 - (tail - q->head_cache);
+    }
+
+    return space;
+}
+
+/* 消费者: 已有元素不足n时才重新读取tail */
+static inline unsigned int used_space(struct spsc_deque *q, unsigned int head, unsigned int n)
+{
+    unsigned int used = q->tail_cache - head;
+
+    if (used < n) {
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        used = q->tail_cache - head;
+    }
+
+    return used;
+}
+
+int spsc_deque_push_back(struct spsc_deque *q, deque_element_type d)
+{
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    if (free_space(q, tail, 1) == 0)
+        return -2;
+
+    q->data[tail & q->mask] = d;
+
+    /* release: 消费者看到新的tail时，一定能看到写入的数据 */
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+
+    return 0;
+}
+
+int spsc_deque_pop_front(struct spsc_deque *q, deque_element_type *to)
+{
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    if (used_space(q, head, 1) == 0)
+        return -2;
+
+    *to = q->data[head & q->mask];
+
+    /* release: 生产者看到新的head时，该位置的数据已经读走 */
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+
+    return 0;
+}
+
+/* 最多放入n个，跨过缓冲区末尾时分两段拷贝，返回实际放入的个数 */
+int spsc_deque_push_back_n(struct spsc_deque *q, const deque_element_type *src, int n)
+{
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned int space, pos, first;
+
+    if (n <= 0)
+        return 0;
+
+    space = free_space(q, tail, n);
+    if ((unsigned int)n > space)
+        n = space;
+
+    pos = tail & q->mask;
+    first = q->mask + 1 - pos;
+    if (first > (unsigned int)n)
+        first = n;
+
+    memcpy(q->data + pos, src, sizeof(*src) * first);
+    memcpy(q->data, src + first, sizeof(*src) * (n - first));
+
+    atomic_store_explicit(&q->tail, tail + n, memory_order_release);
+
+    return n;
+}
+
+/* 最多取出n个，返回实际取出的个数 */
+int spsc_deque_pop_front_n(struct spsc_deque *q, deque_element_type *to, int n)
+{
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned int used, pos, first;
+
+    if (n <= 0)
+        return 0;
+
+    used = used_space(q, head, n);
+    if ((unsigned int)n > used)
+        n = used;
+
+    pos = head & q->mask;
+    first = q->mask + 1 - pos;
+    if (first > (unsigned int)n)
+        first = n;
+
+    memcpy(to, q->data + pos, sizeof(*to) * first);
+    memcpy(to + first, q->data, sizeof(*to) * (n - first));
+
+    atomic_store_explicit(&q->head, head + n, memory_order_release);
+
+    return n;
+}
+
+void spsc_deque_destroy(struct spsc_deque *q)
+{
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return;
+    }
+
+    pool_free(&spsc_pool, q->data);
+    q->data = NULL;
+}
+
+void spsc_deque_pool_stats(struct pool_stats *s)
+{
+    pool_get_stats(&spsc_pool, s);
+}
@@ -0,0 +1,58 @@
+/*
+ * spsc_deque.h
+ *
+ *  Created on: 2024年9月2日
+ *      Author: xdu903
+ */
+
+#ifndef _SPSC_DEQUE_H_
+#define _SPSC_DEQUE_H_
+
+#include "deque.h"
+#include "pool.h"
+#include <stdatomic.h>
+
+#define SPSC_CACHE_LINE (64)
+
+#ifndef SPSC_DEQUE_NUM
+#define SPSC_DEQUE_NUM (8)          /* 队列个数 */
+#endif
+#ifndef SPSC_MAX_NUM
+#define SPSC_MAX_NUM (4096)         /* 每个队列的元素个数，必须是2的幂 */
+#endif
+
+/*
+ * 单生产者/单消费者无锁队列.
+ * 只有一个线程调用push，只有一个线程调用pop，两者之间无需加锁.
+ * head、tail为不回绕的计数，元素个数为tail - head，下标为计数 & mask.
+ */
+struct spsc_deque {
+    /* 生产者写tail，消费者写head，分别放在不同的cache line */
+    _Alignas(SPSC_CACHE_LINE) atomic_uint tail;
+    unsigned int head_cache;    /* 生产者看到的head，不够时才重新读取 */
+
+    _Alignas(SPSC_CACHE_LINE) atomic_uint head;
+    unsigned int tail_cache;    /* 消费者看到的tail */
+
+    _Alignas(SPSC_CACHE_LINE) deque_element_type *data;
+    unsigned int mask;
+};
+
+int spsc_deque_init(struct spsc_deque *q);
+int spsc_deque_push_back(struct spsc_deque *q, deque_element_type d);
+int spsc_deque_pop_front(struct spsc_deque *q, deque_element_type *to);
+int spsc_deque_push_back_n(struct spsc_deque *q, const deque_element_type *src, int n);
+int spsc_deque_pop_front_n(struct spsc_deque *q, deque_element_type *to, int n);
+
+static inline int spsc_deque_size(struct spsc_deque *q)
+{
+    return (int)(atomic_load_explicit(&q->tail, memory_order_acquire)
+            - atomic_load_explicit(&q->head, memory_order_acquire));
+}
+
+void spsc_deque_destroy(struct spsc_deque *q);
+
+/* 静态缓冲区的占用情况 */
+void spsc_deque_pool_stats(struct pool_stats *s);
+
+#endif /* _SPSC_DEQUE_H_ */
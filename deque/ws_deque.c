@@ -0,0 +1,124 @@
+/*
+ * ws_deque.c
+ *
+ *  Created on: 2024年10月8日
+ *      Author: xdu903
+ */
+
+#include "ws_deque.h"
+#include <stdio.h>
+
+/* 申请了WS_DEQUE_NUM个队列，每个队列最多有WS_DEQUE_MAX_NUM元素 */
+#pragma DATA_SECTION(ws_buffer, ".static_var")
+static _Atomic deque_element_type ws_buffer[WS_DEQUE_NUM][WS_DEQUE_MAX_NUM];
+static pool_word_t ws_map[POOL_WORDS(WS_DEQUE_NUM)];
+static struct pool ws_pool = POOL_INIT(ws_buffer, ws_map, WS_DEQUE_NUM, sizeof(ws_buffer[0]));
+
+int ws_deque_init(struct ws_deque *q)
+{
+    if (!q) {
+        printf("Queue not exist\n");
+        return -1;
+    }
+
+    q->data = (_Atomic deque_element_type *)pool_alloc(&ws_pool);
+    if (!q->data) {
+        printf("Init: ws deque is full.\n");
+        return -2;
+    }
+
+    q->mask = WS_DEQUE_MAX_NUM - 1;
+    atomic_init(&q->top, 0);
+    atomic_init(&q->bottom, 0);
+
+    return 0;
+}
+
+int ws_deque_push(struct ws_deque *q, deque_element_type d)
+{
+    int b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    int t = atomic_load_explicit(&q->top, memory_order_acquire);
+
+    if (b - t > q->mask)
+        return -2;
+
+    atomic_store_explicit(&q->data[b & q->mask], d, memory_order_relaxed);
+
+    /* 元素先于bottom对窃取者可见 */
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+
+    return 0;
+}
+
+int ws_deque_pop(struct ws_deque *q, deque_element_type *to)
+{
+    int b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    int t, ret = 0;
+
+    /* 先占住底部的元素，再读top，两者之间需要全序 */
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    t = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+    if (t > b) {
+        /* 已空 */
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        return WS_EMPTY;
+    }
+
+    *to = atomic_load_explicit(&q->data[b & q->mask], memory_order_relaxed);
+
+    if (t == b) {
+        /* 最后一个元素，与窃取者争抢 */
+        if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+                memory_order_seq_cst, memory_order_relaxed))
+            ret = WS_EMPTY;
+
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    }
+
+    return ret;
+}
+
+int ws_deque_steal(struct ws_deque *q, deque_element_type *to)
+{
+    int t = atomic_load_explicit(&q->top, memory_order_acquire);
+    int b;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+
+    if (t >= b)
+        return WS_EMPTY;
+
+    *to = atomic_load_explicit(&q->data[t & q->mask], memory_order_relaxed);
+
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1,
+            memory_order_seq_cst, memory_order_relaxed))
+        return WS_ABORT;
+
+    return 0;
+}
+
+void ws_deque_clear(struct ws_deque *q)
+{
+    atomic_store(&q->top, 0);
+    atomic_store(&q->bottom, 0);
+}
+
+void ws_deque_destroy(struct ws_deque *q)
+{
+    if (!q || !q->data) {
+        printf("Queue is not initialized\n");
+        return;
+    }
+
+    pool_free(&ws_pool, (void *)q->data);
+    q->data = NULL;
+}
+
+void ws_deque_pool_stats(struct pool_stats *s)
+{
+    pool_get_stats(&ws_pool, s);
+}
@@ -0,0 +1,68 @@
+/*
+ * ws_deque.h
+ *
+ *  Created on: 2024年10月8日
+ *      Author: xdu903
+ */
+
+#ifndef _WS_DEQUE_H_
+#define _WS_DEQUE_H_
+
+#include "deque.h"
+#include "pool.h"
+#include <stdatomic.h>
+
+#define WS_CACHE_LINE (64)
+
+#ifndef WS_DEQUE_NUM
+#define WS_DEQUE_NUM (8)            /* 队列个数 */
+#endif
+#ifndef WS_DEQUE_MAX_NUM
+#define WS_DEQUE_MAX_NUM (4096)     /* 每个队列的元素个数，必须是2的幂 */
+#endif
+
+#define WS_EMPTY (-2)               /* 队列为空 */
+#define WS_ABORT (-3)               /* 与其他线程争抢失败，可以重试 */
+
+/*
+ * Chase-Lev工作窃取队列(C11内存模型的版本).
+ * 只有所有者线程在底部(bottom)push、pop，后进先出;
+ * 其他线程在顶部(top)steal，先进先出. 只剩一个元素时pop与steal用CAS争抢top.
+ * top、bottom为不回绕的计数，同一轮使用中push的总数不能超过2^31，
+ * 可在没有其他线程访问时用ws_deque_clear复位.
+ */
+struct ws_deque {
+    _Alignas(WS_CACHE_LINE) atomic_int top;
+    _Alignas(WS_CACHE_LINE) atomic_int bottom;
+    _Alignas(WS_CACHE_LINE) _Atomic deque_element_type *data;
+    int mask;
+};
+
+int ws_deque_init(struct ws_deque *q);
+
+/* 所有者调用，满时返回-2 */
+int ws_deque_push(struct ws_deque *q, deque_element_type d);
+
+/* 所有者调用，空时返回WS_EMPTY */
+int ws_deque_pop(struct ws_deque *q, deque_element_type *to);
+
+/* 其他线程调用，返回0、WS_EMPTY或WS_ABORT */
+int ws_deque_steal(struct ws_deque *q, deque_element_type *to);
+
+/* 并发时只是近似值 */
+static inline int ws_deque_size(struct ws_deque *q)
+{
+    int n = atomic_load_explicit(&q->bottom, memory_order_relaxed)
+            - atomic_load_explicit(&q->top, memory_order_relaxed);
+
+    return n > 0 ? n : 0;
+}
+
+void ws_deque_clear(struct ws_deque *q);
+
+void ws_deque_destroy(struct ws_deque *q);
+
+/* 静态缓冲区的占用情况 */
+void ws_deque_pool_stats(struct pool_stats *s);
+
+#endif /* _WS_DEQUE_H_ */
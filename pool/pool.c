@@ -0,0 +1,176 @@
+/*
+ * pool.c
+ *
+ *  Created on: 2024年9月16日
+ *      Author: xdu903
+ */
+
+#include "pool.h"
+#include <stdio.h>
+
+#define WORD_FULL (~0u)
+
+#if POOL_ATOMIC
+#define word_load(w)            atomic_load(w)
+#define word_load_relaxed(w)    atomic_load_explicit(w, memory_order_relaxed)
+#define word_cas(w, old, v)     atomic_compare_exchange_weak(w, old, v)
+#define word_or(w, v)           atomic_fetch_or(w, v)
+#define word_and(w, v)          atomic_fetch_and(w, v)
+#define word_add_relaxed(w, v)  atomic_fetch_add_explicit(w, v, memory_order_relaxed)
+#define word_sub_relaxed(w, v)  atomic_fetch_sub_explicit(w, v, memory_order_relaxed)
+#else
+/* 单线程的版本，返回值与C11的原子操作相同 */
+static inline unsigned int word_load(pool_word_t *w)
+{
+    return *w;
+}
+
+static inline int word_cas(pool_word_t *w, unsigned int *old, unsigned int v)
+{
+    if (*w != *old) {
+        *old = *w;
+        return 0;
+    }
+
+    *w = v;
+    return 1;
+}
+
+static inline unsigned int word_or(pool_word_t *w, unsigned int v)
+{
+    unsigned int old = *w;
+
+    *w = old | v;
+    return old;
+}
+
+static inline unsigned int word_and(pool_word_t *w, unsigned int v)
+{
+    unsigned int old = *w;
+
+    *w = old & v;
+    return old;
+}
+
+static inline unsigned int word_add_relaxed(pool_word_t *w, unsigned int v)
+{
+    unsigned int old = *w;
+
+    *w = old + v;
+    return old;
+}
+
+#define word_load_relaxed(w)    word_load(w)
+#define word_sub_relaxed(w, v)  word_add_relaxed(w, 0u - (v))
+#endif
+
+/* 第w个字中有效位的掩码，槽数不是32的倍数时最后一个字只有低位有效 */
+static inline unsigned int valid_bits(struct pool *p, unsigned int w)
+{
+    unsigned int rest = p->nslot - w * POOL_WORD_BITS;
+
+    return rest >= POOL_WORD_BITS ? WORD_FULL : (1u << rest) - 1;
+}
+
+static inline void update_peak(struct pool *p, unsigned int used)
+{
+    unsigned int peak = word_load_relaxed(&p->peak);
+
+    while (used > peak && !word_cas(&p->peak, &peak, used))
+        ;
+}
+
+void *pool_alloc(struct pool *p)
+{
+    unsigned int nword = POOL_WORDS(p->nslot);
+    unsigned int all = nword >= POOL_WORD_BITS ? WORD_FULL : (1u << nword) - 1;
+    unsigned int full, old, w, bit, i;
+
+    if (p->nslot > POOL_MAX_SLOT) {
+        printf("pool_alloc: %u slots exceed %u.\n", p->nslot, POOL_MAX_SLOT);
+        return NULL;
+    }
+
+    for (;;) {
+        full = word_load(&p->full);
+        if ((full & all) == all)
+            break;
+
+        w = pool_ctz(~full);
+        old = word_load(&p->map[w]);
+
+        /* 该字已满，full尚未更新 */
+        if ((old | ~valid_bits(p, w)) == WORD_FULL) {
+            word_or(&p->full, 1u << w);
+
+            /* 置位期间可能有槽被释放，重新检查 */
+            if ((word_load(&p->map[w]) | ~valid_bits(p, w)) != WORD_FULL)
+                word_and(&p->full, ~(1u << w));
+            continue;
+        }
+
+        bit = pool_ctz(~old);
+        if (!word_cas(&p->map[w], &old, old | (1u << bit)))
+            continue;
+
+        i = w * POOL_WORD_BITS + bit;
+
+        update_peak(p, word_add_relaxed(&p->used, 1) + 1);
+        word_add_relaxed(&p->nalloc, 1);
+
+        return p->base + (size_t)i * p->slot_size;
+    }
+
+    word_add_relaxed(&p->nfail, 1);
+
+    return NULL;
+}
+
+int pool_index(struct pool *p, const void *slot)
+{
+    const char *c = (const char *)slot;
+    size_t off;
+
+    if (c < p->base)
+        return -1;
+
+    off = (size_t)(c - p->base);
+    if (off % p->slot_size || off / p->slot_size >= p->nslot)
+        return -1;
+
+    return (int)(off / p->slot_size);
+}
+
+void pool_free(struct pool *p, void *slot)
+{
+    int i = pool_index(p, slot);
+    unsigned int w, bit;
+
+    if (i < 0) {
+        printf("pool_free: slot does not belong to the pool.\n");
+        return;
+    }
+
+    w = i / POOL_WORD_BITS;
+    bit = 1u << (i % POOL_WORD_BITS);
+
+    if (!(word_load(&p->map[w]) & bit)) {
+        printf("pool_free: slot %d is not allocated.\n", i);
+        return;
+    }
+
+    /* 先减计数再释放，其他线程随后申请到该槽时used不会超过槽数 */
+    word_sub_relaxed(&p->used, 1);
+    word_and(&p->map[w], ~bit);
+    word_and(&p->full, ~(1u << w));
+}
+
+void pool_get_stats(struct pool *p, struct pool_stats *s)
+{
+    s->nslot = p->nslot;
+    s->slot_size = p->slot_size;
+    s->used = word_load_relaxed(&p->used);
+    s->peak = word_load_relaxed(&p->peak);
+    s->nalloc = word_load_relaxed(&p->nalloc);
+    s->nfail = word_load_relaxed(&p->nfail);
+}
@@ -0,0 +1,102 @@
+/*
+ * pool.h
+ *
+ *  Created on: 2024年9月16日
+ *      Author: xdu903
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <stddef.h>
+
+#ifdef _TMS320C6X
+#include <c6x.h>
+#endif
+
+/*
+ * POOL_ATOMIC为1时位图和统计用C11原子操作更新，多个线程可以同时申请、释放;
+ * 为0时为普通的unsigned int，只能在一个线程中使用，或由调用者加锁.
+ * 默认只在支持C11原子操作的C编译器上打开: TI C6x编译器没有<stdatomic.h>，
+ * C++中包含deque.h、stack.h时也不需要它. 使用同一个池的源文件须取相同的值.
+ */
+#ifndef POOL_ATOMIC
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__) && !defined(_TMS320C6X)
+#define POOL_ATOMIC 1
+#else
+#define POOL_ATOMIC 0
+#endif
+#endif
+
+#if POOL_ATOMIC
+#include <stdatomic.h>
+typedef atomic_uint pool_word_t;
+#else
+typedef unsigned int pool_word_t;
+#endif
+
+/*
+ * 固定大小的槽池，deque、stack等容器从中申请缓冲区.
+ * 每个槽在map中占一位(1为已占用)，32个槽一个字;
+ * full的第w位为1表示第w个字已满.
+ * 申请时先在full中找未满的字，再在该字中找空闲位，两次ctz，与槽数无关.
+ * POOL_ATOMIC为1时位图用原子操作更新，多个线程可以同时申请、释放.
+ * 一个池最多POOL_MAX_SLOT个槽.
+ */
+#define POOL_WORD_BITS (32)
+#define POOL_MAX_SLOT (POOL_WORD_BITS * POOL_WORD_BITS)
+#define POOL_WORDS(nslot) (((nslot) + POOL_WORD_BITS - 1) / POOL_WORD_BITS)
+
+struct pool {
+    char *base;                 /* nslot * slot_size字节的存储 */
+    unsigned int slot_size;
+    unsigned int nslot;
+    pool_word_t *map;
+    pool_word_t full;
+
+    pool_word_t used;           /* 统计 */
+    pool_word_t peak;
+    pool_word_t nalloc;
+    pool_word_t nfail;
+};
+
+/* 静态初始化，buf为nslot_个槽的存储，map_为POOL_WORDS(nslot_)个pool_word_t的位图 */
+#define POOL_INIT(buf, map_, nslot_, slot_size_) \
+    { .base = (char *)(buf), .slot_size = (slot_size_), .nslot = (nslot_), .map = (map_) }
+
+struct pool_stats {
+    unsigned int nslot;
+    unsigned int slot_size;
+    unsigned int used;          /* 当前占用的槽数 */
+    unsigned int peak;          /* 占用槽数的最大值 */
+    unsigned int nalloc;        /* 成功申请的次数 */
+    unsigned int nfail;         /* 因池满而失败的次数 */
+};
+
+/* 返回槽的首地址，池满时返回NULL */
+void *pool_alloc(struct pool *p);
+void pool_free(struct pool *p, void *slot);
+
+/* 槽的序号，不属于该池时返回-1 */
+int pool_index(struct pool *p, const void *slot);
+
+void pool_get_stats(struct pool *p, struct pool_stats *s);
+
+static inline int pool_ctz(unsigned int x)
+{
+#if defined(_TMS320C6X)
+    return 31 - _lmbd(1, x & -x);
+#elif defined(__GNUC__)
+    return __builtin_ctz(x);
+#else
+    static const unsigned char debruijn[32] = {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
+
+    return debruijn[((x & -x) * 0x077CB531u) >> 27];
+#endif
+}
+
+#endif /* _POOL_H_ */
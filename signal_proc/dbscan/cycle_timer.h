@@ -0,0 +1,65 @@
+/*
+ * cycle_timer.h
+ *
+ *  Created on: 2024-9-9
+ *      Author: xdu
+ */
+
+#ifndef CYCLE_TIMER_H_
+#define CYCLE_TIMER_H_
+
+/*
+ * 读取时间戳计数器:
+ *     C6x      TSCH:TSCL，CPU周期，使用前需调用cycle_timer_init()启动;
+ *     x86      rdtsc，TSC周期;
+ *     其他     clock_gettime(CLOCK_MONOTONIC)，单位为ns.
+ */
+typedef unsigned long long cycle_t;
+
+#if defined(_TMS320C6X)
+#include <c6x.h>
+
+static inline void cycle_timer_init(void)
+{
+	/* 写TSCL启动计数，之后不再停止 */
+	TSCL = 0;
+}
+
+static inline cycle_t cycle_now(void)
+{
+	/* 读TSCL时锁存TSCH，须先读TSCL */
+	unsigned int lo = TSCL;
+	unsigned int hi = TSCH;
+
+	return ((cycle_t)hi << 32) | lo;
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+static inline void cycle_timer_init(void)
+{
+}
+
+static inline cycle_t cycle_now(void)
+{
+	return __rdtsc();
+}
+
+#else
+#include <time.h>
+
+static inline void cycle_timer_init(void)
+{
+}
+
+static inline cycle_t cycle_now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (cycle_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+#endif
+
+#endif /* CYCLE_TIMER_H_ */
@@ -7,14 +7,11 @@
 
 #include "dbscan.h"
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <c6x.h>
 
-#define MAX_NUM (4096)
-
-#define STATIC 1
-#define DYNAMIC 2
-
-#define INIT_MEASURE STATIC
+#define MAX_NUM DBSCAN_MAX_NUM
 
 #define RUNTIME_DEBUG 1
 
@@ -25,20 +22,132 @@
 printf("Debug info: %s function %d line " fmt "\n", __FUNCTION__, __LINE__, ##__VA_ARGS__)
 #endif
 
-#if INIT_MEASURE == STATIC
+#if INIT_DBSCAN_MEASURE == STATIC_DBSCAN_MALLOC
+#include "pool.h"
+
+#define DBSCAN_NUM (4)
+
+/* 一个dbscan_st独占的工作存储，不同实例之间互不干扰 */
+struct dbscan_buffer {
+#if PDW_LAYOUT == PDW_AOS
+	pdw_st set[MAX_NUM];
+#endif
 
-int major[MAX_NUM];
-int visited[MAX_NUM];
-pdw_st set[MAX_NUM];
-int new_nbrs[MAX_NUM];
+#if PDW_LAYOUT == PDW_SOA
+	unsigned int aoa[MAX_NUM];
+	unsigned int freq[MAX_NUM];
+	unsigned int pw[MAX_NUM];
+#endif
+
+	dbscan_label_t major[MAX_NUM];
+	dbscan_state_t visited[MAX_NUM];
+	pt_index_t new_nbrs[MAX_NUM];
+
+#if DBSCAN_FLAT_QUEUE
+	pt_index_t queue[MAX_NUM];
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID || NBR_SEARCH_MEASURE == NBR_SORTED_SWEEP
+	pt_index_t index_perm[MAX_NUM];
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID
+	unsigned long long index_key[MAX_NUM];
+	int index_start[MAX_NUM + 1];
+#endif
+
+#if NBR_GRAPH
+	int graph_offset[MAX_NUM + 1];
+	pt_index_t graph_edge[NBR_GRAPH_MAX_EDGES];
+#endif
+
+#if DBSCAN_DEDUP
+	pt_index_t weight[MAX_NUM];
+	pt_index_t dedup_orig[MAX_NUM];
+	pt_index_t dedup_link[MAX_NUM];
+	pt_index_t dedup_head[MAX_NUM];
+#endif
+};
+
+/*
+ * 申请了DBSCAN_NUM份工作存储，与deque、stack相同，通过槽池分配，
+ * 不同线程可以同时init_dbscan()/del_dbscan().
+ */
+#pragma DATA_SECTION(dbscan_buffer, ".static_var")
+static struct dbscan_buffer dbscan_buffer[DBSCAN_NUM];
+static pool_word_t dbscan_map[POOL_WORDS(DBSCAN_NUM)];
+static struct pool dbscan_pool = POOL_INIT(dbscan_buffer, dbscan_map, DBSCAN_NUM,
+		sizeof(dbscan_buffer[0]));
 
 static int init(dbscan_st *db, unsigned int num)
 {
-	db->set = set;
-	db->major = major;
-	db->visited = visited;
+	struct dbscan_buffer *buf;
+
+	if (num > MAX_NUM) {
+		printf("init: %u points exceed MAX_NUM.\n", num);
+		return -1;
+	}
+
+	buf = (struct dbscan_buffer *)pool_alloc(&dbscan_pool);
+	if (!buf) {
+		printf("init: dbscan buffer is full.\n");
+		return -2;
+	}
+
+#if !DBSCAN_FLAT_QUEUE
+	if (deque_init(&db->finded_pts) < 0) {
+		pool_free(&dbscan_pool, buf);
+		return -2;
+	}
+#endif
+
+	db->slot = pool_index(&dbscan_pool, buf);
+	db->size = MAX_NUM;
+
+#if PDW_LAYOUT == PDW_AOS
+	db->set = db->own_set = buf->set;
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	db->aoa = buf->aoa;
+	db->freq = buf->freq;
+	db->pw = buf->pw;
+#endif
 
-	deque_init(&db->finded_pts);
+	db->major = buf->major;
+	db->visited = buf->visited;
+	db->new_nbrs = buf->new_nbrs;
+
+#if DBSCAN_FLAT_QUEUE
+	db->queue = buf->queue;
+	db->qhead = db->qtail = 0;
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID || NBR_SEARCH_MEASURE == NBR_SORTED_SWEEP
+	db->index.perm = buf->index_perm;
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID
+	db->index.key = buf->index_key;
+	db->index.start = buf->index_start;
+	db->index.ncell = 0;
+#endif
+
+#if NBR_GRAPH
+	db->graph.offset = buf->graph_offset;
+	db->graph.edge = buf->graph_edge;
+	db->graph.cap = NBR_GRAPH_MAX_EDGES;
+	db->graph.valid = 0;
+#endif
+
+#if DBSCAN_DEDUP
+	db->weight = buf->weight;
+	db->dedup_orig = buf->dedup_orig;
+	db->dedup_link = buf->dedup_link;
+	db->dedup_head = buf->dedup_head;
+	db->nbucket = MAX_NUM;
+	db->npoint = 0;
+#endif
 
 	memset(db->major, -1, sizeof(db->major[0]) * MAX_NUM);
 	memset(db->visited, UNLABELED, sizeof(db->visited[0]) * MAX_NUM);
@@ -48,33 +157,274 @@ static int init(dbscan_st *db, unsigned int num)
 
 static void del(dbscan_st *db)
 {
-	db->set = NULL;
+	/* init_dbscan()失败时slot为-1，没有可释放的 */
+	if (db->slot < 0)
+		return;
+
+	pool_free(&dbscan_pool, &dbscan_buffer[db->slot]);
+	db->slot = -1;
+
+#if PDW_LAYOUT == PDW_AOS
+	db->set = db->own_set = NULL;
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	db->aoa = NULL;
+	db->freq = NULL;
+	db->pw = NULL;
+#endif
+
 	db->major = NULL;
 	db->visited = NULL;
+	db->new_nbrs = NULL;
 
+#if DBSCAN_FLAT_QUEUE
+	db->queue = NULL;
+#else
 	deque_destroy(&db->finded_pts);
+#endif
+}
+#endif
+
+#if INIT_DBSCAN_MEASURE == DYNAMIC_DBSCAN_MALLOC
+
+/* 从arena中依次切出各数组，按32字节对齐，便于向量化访问 */
+static size_t carve(size_t *off, size_t bytes)
+{
+	size_t at = *off;
+
+	*off += (bytes + 31) & ~(size_t)31;
+
+	return at;
 }
+
+#define CARVE(field, type, n) \
+do { \
+	size_t at_ = carve(&off, sizeof(type) * (n)); \
+	if (base) \
+		field = (type *)(base + at_); \
+} while (0)
+
+/* 计算num个点所需的arena大小，base非空时同时设置各数组指针 */
+static size_t layout(dbscan_st *db, char *base, unsigned int num)
+{
+	size_t off = 0;
+
+#if PDW_LAYOUT == PDW_AOS
+	CARVE(db->set, pdw_st, num);
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	CARVE(db->aoa, unsigned int, num);
+	CARVE(db->freq, unsigned int, num);
+	CARVE(db->pw, unsigned int, num);
 #endif
 
-#if INIT_MEASURE == DYNAMIC
+	CARVE(db->major, dbscan_label_t, num);
+	CARVE(db->visited, dbscan_state_t, num);
+	CARVE(db->new_nbrs, pt_index_t, num);
+	CARVE(db->queue, pt_index_t, num);
+
+#if NBR_SEARCH_MEASURE == NBR_GRID || NBR_SEARCH_MEASURE == NBR_SORTED_SWEEP
+	CARVE(db->index.perm, pt_index_t, num);
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID
+	CARVE(db->index.key, unsigned long long, num);
+	CARVE(db->index.start, int, num + 1);
+#endif
+
+#if NBR_GRAPH
+	/* 边数不会超过num * num */
+	db->graph.cap = (unsigned long long)num * num < NBR_GRAPH_MAX_EDGES
+			? num * num : NBR_GRAPH_MAX_EDGES;
+	CARVE(db->graph.offset, int, num + 1);
+	CARVE(db->graph.edge, pt_index_t, db->graph.cap);
+#endif
+
+#if DBSCAN_DEDUP
+	/* 桶数取不小于num的2的幂 */
+	for (db->nbucket = 1; db->nbucket < num; db->nbucket <<= 1)
+		;
+	CARVE(db->weight, pt_index_t, num);
+	CARVE(db->dedup_orig, pt_index_t, num);
+	CARVE(db->dedup_link, pt_index_t, num);
+	CARVE(db->dedup_head, pt_index_t, db->nbucket);
+#endif
+
+	return off;
+}
+
 static int init(dbscan_st *db, unsigned int num)
 {
-	/* 待实现 */
+	/* 所有工作存储一次申请，之后每帧通过reset_dbscan()复用 */
+	db->arena = (char *)malloc(layout(db, NULL, num ? num : 1));
+	if (!db->arena) {
+		printf("init: malloc dbscan arena failed.\n");
+		return -1;
+	}
+
+	layout(db, db->arena, num ? num : 1);
+	db->size = num;
+	db->qhead = db->qtail = 0;
+
+#if PDW_LAYOUT == PDW_AOS
+	db->own_set = db->set;
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID
+	db->index.ncell = 0;
+#endif
+
+#if NBR_GRAPH
+	db->graph.valid = 0;
+#endif
+
+#if DBSCAN_DEDUP
+	db->npoint = 0;
+#endif
+
+	memset(db->major, -1, sizeof(db->major[0]) * num);
+	memset(db->visited, UNLABELED, sizeof(db->visited[0]) * num);
+
+	return 0;
 }
 
 static void del(dbscan_st *db)
 {
-	/* 待实现 */
+	free(db->arena);
+	db->arena = NULL;
+	db->size = 0;
+
+#if PDW_LAYOUT == PDW_AOS
+	db->set = db->own_set = NULL;
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	db->aoa = NULL;
+	db->freq = NULL;
+	db->pw = NULL;
+#endif
+
+	db->major = NULL;
+	db->visited = NULL;
+	db->new_nbrs = NULL;
+	db->queue = NULL;
+}
+#endif
+
+/*
+ * 待扩展点队列，非紧凑的STATIC时使用deque，否则使用工作存储中的点序号数组.
+ * 每个点每帧最多入队一次，队列长度不超过点数，可以不做检查
+ * (静态的deque不小于DBSCAN_MAX_NUM，见dbscan.h).
+ */
+#if !DBSCAN_FLAT_QUEUE
+static inline void queue_push_n(dbscan_st *db, const pt_index_t *pts, int n)
+{
+	deque_push_back_n(&db->finded_pts, pts, n);
+}
+
+static inline int queue_pop(dbscan_st *db)
+{
+	return deque_pop_front_fast(&db->finded_pts);
+}
+
+static inline bool queue_empty(dbscan_st *db)
+{
+	return deque_empty(&db->finded_pts);
+}
+
+static inline void queue_clear(dbscan_st *db)
+{
+	deque_clear(&db->finded_pts);
+}
+
+static inline unsigned int queue_size(dbscan_st *db)
+{
+	return deque_size(&db->finded_pts);
+}
+#endif
+
+#if DBSCAN_FLAT_QUEUE
+/* 长度为num的数组不会溢出，也无需回绕 */
+static inline void queue_push_n(dbscan_st *db, const pt_index_t *pts, int n)
+{
+	memcpy(db->queue + db->qtail, pts, sizeof(pt_index_t) * n);
+	db->qtail += n;
+}
+
+static inline int queue_pop(dbscan_st *db)
+{
+	return db->queue[db->qhead++];
+}
+
+static inline bool queue_empty(dbscan_st *db)
+{
+	return db->qhead == db->qtail;
+}
+
+static inline void queue_clear(dbscan_st *db)
+{
+	db->qhead = db->qtail = 0;
+}
+
+static inline unsigned int queue_size(dbscan_st *db)
+{
+	return db->qtail - db->qhead;
 }
 #endif
 
 int init_dbscan(dbscan_st *db, unsigned int num)
 {
+	/* 先标记为未申请，init_dbscan()失败后调用del_dbscan()也是安全的 */
+#if INIT_DBSCAN_MEASURE == STATIC_DBSCAN_MALLOC
+	db->slot = -1;
+#endif
+#if INIT_DBSCAN_MEASURE == DYNAMIC_DBSCAN_MALLOC
+	db->arena = NULL;
+#endif
+
+#if DBSCAN_PROF
+	cycle_timer_init();
+	memset(&db->prof, 0, sizeof(db->prof));
+#endif
+
+	/* 点序号与类编号的位宽决定了一帧的点数上限 */
+	if (num > PT_INDEX_MAX || num > DBSCAN_LABEL_MAX) {
+		printf("init: %u points exceed the index or label width.\n", num);
+		return -1;
+	}
+
 	db->capacity = num;
 
 	return init(db, num);
 }
 
+int reset_dbscan(dbscan_st *db, unsigned int num)
+{
+	if (num > db->size) {
+		printf("reset: %u points exceed %u.\n", num, db->size);
+		return -1;
+	}
+
+	db->capacity = num;
+	db->ngroup = 0;
+
+	memset(db->major, -1, sizeof(db->major[0]) * num);
+	memset(db->visited, UNLABELED, sizeof(db->visited[0]) * num);
+	queue_clear(db);
+
+#if NBR_GRAPH
+	db->graph.valid = 0;
+#endif
+
+#if DBSCAN_DEDUP
+	db->npoint = 0;
+#endif
+
+	return 0;
+}
+
 void del_dbscan(dbscan_st *db)
 {
 	del(db);
@@ -83,50 +433,296 @@ void del_dbscan(dbscan_st *db)
 int get_data(dbscan_st *db, const ORIG_PDW *src)
 {
 	int i = 0;
+	PROF_DECL(t0);
 
-	while (i < db->capacity) {
-		pdw_st *p = &(db->set[i]);
+	PROF_START(t0);
 
-		p->aoa = src[i].AOA;
-		p->freq = src[i].FC;
-		p->pw = src[i].PW;
+#if PDW_LAYOUT == PDW_AOS
+	/* 之前attach_data()时set指向外部，改回工作存储 */
+	db->set = db->own_set;
+#endif
+
+	while (i < db->capacity) {
+		PDW_AOA(db, i) = src[i].AOA;
+		PDW_FREQ(db, i) = src[i].FC;
+		PDW_PW(db, i) = src[i].PW;
 
 		++i;
 	}
 
+#if NBR_GRAPH
+	db->graph.valid = 0;
+#endif
+
+#if DBSCAN_PROF
+	db->prof.get_data = cycle_now() - t0;
+#endif
+
 	return i;
 }
 
-static inline unsigned int distance(pdw_st *p1, pdw_st *p2)
+int attach_data(dbscan_st *db, pdw_st *set)
 {
-	/* T = |A(:, k) ^ W(:, j)| / (|W(:, j)| + a) */
-	return abs(p1->aoa - p2->aoa) + abs(p1->pw - p2->pw);
+#if PDW_LAYOUT == PDW_SOA
+	int i;
+#endif
+	PROF_DECL(t0);
+
+	PROF_START(t0);
+
+#if PDW_LAYOUT == PDW_AOS
+	/* 布局相同，直接引用 */
+	db->set = set;
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	for (i = 0; i < db->capacity; ++i) {
+		PDW_AOA(db, i) = set[i].aoa;
+		PDW_FREQ(db, i) = set[i].freq;
+		PDW_PW(db, i) = set[i].pw;
+	}
+#endif
+
+#if NBR_GRAPH
+	db->graph.valid = 0;
+#endif
+
+#if DBSCAN_PROF
+	db->prof.get_data = cycle_now() - t0;
+#endif
+
+	return db->capacity;
 }
 
-static int search_nbr(dbscan_st *db, int point, unsigned int e)
+#if DBSCAN_DEDUP
+/* 交换第a与第b个点的数据和状态 */
+static void swap_point(dbscan_st *db, int a, int b)
 {
-	int j = 0;
-	int nnbr = 0;
-	int length = db->capacity;
-	pdw_st *pdw_set = db->set;
-	pdw_st *src_point = &(pdw_set[point]);
+	unsigned int v;
+	int t;
+
+	v = PDW_AOA(db, a);
+	PDW_AOA(db, a) = PDW_AOA(db, b);
+	PDW_AOA(db, b) = v;
+
+	v = PDW_FREQ(db, a);
+	PDW_FREQ(db, a) = PDW_FREQ(db, b);
+	PDW_FREQ(db, b) = v;
+
+	v = PDW_PW(db, a);
+	PDW_PW(db, a) = PDW_PW(db, b);
+	PDW_PW(db, b) = v;
+
+	t = db->major[a];
+	db->major[a] = db->major[b];
+	db->major[b] = t;
+
+	t = db->visited[a];
+	db->visited[a] = db->visited[b];
+	db->visited[b] = t;
+
+	t = db->dedup_orig[a];
+	db->dedup_orig[a] = db->dedup_orig[b];
+	db->dedup_orig[b] = t;
 
-	for (j = 0; j < length; ++j) {
-        if (distance(src_point, &(pdw_set[j])) > e)
-		    continue;
+	t = db->dedup_link[a];
+	db->dedup_link[a] = db->dedup_link[b];
+	db->dedup_link[b] = t;
+}
+
+/* 散列链表的结尾，点数不超过PT_INDEX_MAX，不会与点序号重复 */
+#define DEDUP_NIL PT_INDEX_MAX
+
+static inline unsigned int dedup_key(unsigned int v, unsigned int q)
+{
+	return q ? v / q : v;
+}
 
-        new_nbrs[nnbr] = j;
-		++nnbr;
+int dbscan_dedup(dbscan_st *db, unsigned int q)
+{
+	unsigned int mask = db->nbucket - 1;
+	unsigned int ka, kf, kp, h;
+	int n = db->capacity;
+	int i, r, nu = 0;
+
+	/* 已合并过 */
+	if (db->npoint)
+		return n;
+
+	for (i = 0; i <= mask; ++i)
+		db->dedup_head[i] = DEDUP_NIL;
+
+	for (i = 0; i < n; ++i)
+		db->dedup_orig[i] = i;
+
+	/* [0, nu)为已合并的点，[nu, i)为重复点 */
+	for (i = 0; i < n; ++i) {
+		ka = dedup_key(PDW_AOA(db, i), q);
+		kf = METRIC_FREQ ? dedup_key(PDW_FREQ(db, i), q) : 0;
+		kp = dedup_key(PDW_PW(db, i), q);
+		h = ka * 0x9E3779B1u ^ kf * 0xC2B2AE3Du ^ kp * 0x85EBCA77u;
+		h = (h ^ (h >> 16)) & mask;
+
+		for (r = db->dedup_head[h]; r != DEDUP_NIL; r = db->dedup_link[r]) {
+			if (dedup_key(PDW_AOA(db, r), q) == ka && dedup_key(PDW_PW(db, r), q) == kp
+					&& (!METRIC_FREQ || dedup_key(PDW_FREQ(db, r), q) == kf))
+				break;
+		}
+
+		if (r != DEDUP_NIL) {
+			++db->weight[r];
+			db->dedup_link[i] = r;
+			continue;
+		}
+
+		/* 新的点换到nu处，原来在nu处的重复点换到i处 */
+		swap_point(db, i, nu);
+		db->weight[nu] = 1;
+		db->dedup_link[nu] = db->dedup_head[h];
+		db->dedup_head[h] = nu;
+		++nu;
 	}
 
-	return nnbr;
+	db->npoint = n;
+	db->capacity = nu;
+
+#if NBR_GRAPH
+	db->graph.valid = 0;
+#endif
+
+	return nu;
 }
 
+void dbscan_scatter(dbscan_st *db)
+{
+	int n = db->npoint;
+	int k, r;
+
+	if (!n)
+		return;
+
+	/* 重复点取所归并到的点的结果 */
+	for (k = db->capacity; k < n; ++k) {
+		r = db->dedup_link[k];
+		db->major[k] = db->major[r];
+		db->visited[k] = db->visited[r];
+	}
+
+	/* 按原始序号换回原来的位置，每次交换放好一个点 */
+	for (k = 0; k < n; ++k) {
+		while ((r = db->dedup_orig[k]) != k)
+			swap_point(db, k, r);
+	}
+
+	db->capacity = n;
+	db->npoint = 0;
+
+#if NBR_GRAPH
+	db->graph.valid = 0;
+#endif
+}
+#endif
+
+/* 寻找point的e领域，nbrs指向结果 */
+static int search_nbr(dbscan_st *db, int point, unsigned int e, pt_index_t **nbrs)
+{
+#if NBR_GRAPH
+	struct nbr_graph *gr = &db->graph;
+
+	if (point < gr->built) {
+		*nbrs = gr->edge + gr->offset[point];
+		return gr->offset[point + 1] - gr->offset[point];
+	}
+#endif
+
+	*nbrs = db->new_nbrs;
+	return nbr_index_search(db, point, e, db->new_nbrs);
+}
+
+/*
+ * 把nbrs中未标记的点归入第g类，其中非边界点按原顺序整段放入队列.
+ * 待入队的点压缩到new_nbrs中，nbrs就是new_nbrs时写位置不超过读位置.
+ */
+static inline void mark_nbrs(dbscan_st *db, const pt_index_t *nbrs, int nnbr, int g)
+{
+	pt_index_t *pts = db->new_nbrs;
+	int j, k, m = 0;
+
+	for (k = 0; k < nnbr; ++k) {
+		j = nbrs[k];
+
+		if (db->visited[j] == LABELED)
+			continue;
+
+		/* 若j不是边界点，则它可能有密度直达点  */
+		if (db->visited[j] != EDGE)
+			pts[m++] = j;
+
+		db->visited[j] = LABELED;
+		db->major[j] = g;
+	}
+
+	queue_push_n(db, pts, m);
+	PROF_MAX(db, queue_peak, queue_size(db));
+}
+
+#if DBSCAN_PROF
+/* get_data()以外的统计每次dbscan()时清零 */
+static void prof_reset(dbscan_st *db)
+{
+	cycle_t t = db->prof.get_data;
+
+	memset(&db->prof, 0, sizeof(db->prof));
+	db->prof.get_data = t;
+}
+
+static void prof_finish(dbscan_st *db, cycle_t total)
+{
+	int i;
+
+	db->prof.expand = total - db->prof.search;
+	db->prof.ncluster = db->ngroup;
+
+	for (i = 0; i < db->capacity; ++i)
+		db->prof.nnoise += db->major[i] < 0;
+}
+
+void dbscan_get_prof(const dbscan_st *db, struct dbscan_prof *prof)
+{
+	*prof = db->prof;
+}
+#endif
+
 void dbscan(dbscan_st *db, unsigned int e, unsigned int minpts)
 {
-    int i = 0, j, k;
+    int i = 0, j;
     int g = 0;
     int nnbr;
+    pt_index_t *nbrs;
+    PROF_DECL(t0);
+    PROF_DECL(t1);
+
+#if DBSCAN_PROF
+    prof_reset(db);
+#endif
+    PROF_START(t0);
+    PROF_START(t1);
+
+    /* 同一帧可以用不同的minpts重复聚类 */
+    memset(db->major, -1, sizeof(db->major[0]) * db->capacity);
+    memset(db->visited, UNLABELED, sizeof(db->visited[0]) * db->capacity);
+    queue_clear(db);
+
+#if NBR_GRAPH
+    /* 同一帧、相同的e，直接使用上次建立的e领域图 */
+    if (!db->graph.valid || db->graph.e != e) {
+        nbr_index_build(db, e);
+        nbr_graph_build(db, e);
+    }
+#else
+    nbr_index_build(db, e);
+#endif
+    PROF_STOP(db, search, t1);
 
     for (i = 0; i < db->capacity; ++i) {
         /* 若i的状态为LABELED，表示i已经被标记过 */
@@ -134,10 +730,12 @@ void dbscan(dbscan_st *db, unsigned int e, unsigned int minpts)
             continue;
 
         /* 寻找i的e领域内的所有点 */
-        nnbr = search_nbr(db, i, e);
+        PROF_START(t1);
+        nnbr = search_nbr(db, i, e, &nbrs);
+        PROF_STOP(db, search, t1);
 
         /* 若i不是核心点，则标记为边界点，继续寻找核心点 */
-        if (nnbr < minpts) {
+        if (nbr_weight(db, nbrs, nnbr) < minpts) {
             db->visited[i] = EDGE;
             continue;
         }
@@ -146,72 +744,34 @@ void dbscan(dbscan_st *db, unsigned int e, unsigned int minpts)
         db->visited[i] = LABELED;
         db->major[i] = g;
 
-        for (k = 0; k < nnbr; ++k) {
-            j = new_nbrs[k];
-
-            if (db->visited[j] == LABELED)
-                continue;
-
-            /* 若j不是边界点，则它可能有密度直达点  */
-            if (db->visited[j] != EDGE) {
-                deque_push_back(&db->finded_pts, j);
-
-            db->visited[j] = LABELED;
-            db->major[j] = g;
-        }
+        mark_nbrs(db, nbrs, nnbr, g);
 
         /* 寻找i密度可达的点 */
-        while (!deque_empty(&db->finded_pts)) {
-            deque_pop_front(&db->finded_pts, &j);
+        while (!queue_empty(db)) {
+            j = queue_pop(db);
 
             /* j是i密度直达或密度可达的点, 寻找j的e领域内的所有的点 */
-            nnbr = search_nbr(db, j, e);
+            PROF_START(t1);
+            nnbr = search_nbr(db, j, e, &nbrs);
+            PROF_STOP(db, search, t1);
 
             /* j不是核心点，j的e领域内的点不是j的密度直达点，也就不是i的密度可达点 */
-            if (nnbr < minpts) {
+            if (nbr_weight(db, nbrs, nnbr) < minpts) {
                 continue;
             }
 
             /* j是核心点，那么j的密度直达点就是i的密度可达点 */
-            for (k = 0; k < nnbr; ++k) {
-                j = new_nbrs[k];
-
-                if (db->visited[j] == LABELED)
-                    continue;
-
-                /* 若j不是边界点，则它可能有密度直达点  */
-                if (db->visited[j] != EDGE)
-                    deque_push_back(&db->finded_pts, j);
-
-                db->visited[j] = LABELED;
-                db->major[j] = g;
-            }
+            mark_nbrs(db, nbrs, nnbr, g);
         }
     }
 
     db->ngroup = g;
-}
-
-void print_dbscan_result(dbscan_st *db)
-{
-	FILE *fptr = NULL;
-	int i;
-
-	fptr = fopen("../simulate/dbscan_sim.txt", "w+");
-	if (!fptr) {
-		printf("can't open sim.txt");
-		return;
-	}
-
-	fprintf(fptr, "---------------------------------------------------------------------------------------------\n");
-	fprintf(fptr, "num                   PW                   FC                   AOA                   cluster\n");
-	fprintf(fptr, "---------------------------------------------------------------------------------------------\n");
-	for (i = 0; i < db->capacity; ++i) {
-		fprintf(fptr, "%-21d %-20d %-20d %-21d %-7d\n", \
-				i, db->set[i].pw, db->set[i].freq, db->set[i].aoa, db->major[i]);
-	}
 
-	fprintf(fptr, "---------------------------------------------------------------------------------------------\n\n");
+#if DBSCAN_DEDUP
+    dbscan_scatter(db);
+#endif
 
-	fclose(fptr);
-}
\ No newline at end of file
+#if DBSCAN_PROF
+    prof_finish(db, cycle_now() - t0);
+#endif
+}
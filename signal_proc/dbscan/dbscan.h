@@ -10,7 +10,11 @@
 
 #include "stack.h"
 #include "deque.h"
+#include "nbr_index.h"
+#include "metric.h"
+#include "dbscan_prof.h"
 #include <stdbool.h>
+#include <stdlib.h>
 #include "srio_adapter.h"
 
 typedef struct pdw {
@@ -24,12 +28,96 @@ typedef struct pdw {
 	unsigned int pw : 32;		/* pulse width */
 }pdw_st;
 
+/*
+ * PDW存放方式:
+ *     PDW_AOS 结构体数组，set[i]中依次存放aoa/freq/pw;
+ *     PDW_SOA 数组结构体，aoa[]/freq[]/pw[]分别连续存放，便于向量化.
+ */
+/*
+ * 工作存储的申请方式:
+ *     STATIC_DBSCAN_MALLOC  静态的DBSCAN_NUM份，每份最多DBSCAN_MAX_NUM个点;
+ *     DYNAMIC_DBSCAN_MALLOC init_dbscan()时按num一次申请，点数不受限制.
+ */
+#define STATIC_DBSCAN_MALLOC 1
+#define DYNAMIC_DBSCAN_MALLOC 2
+
+#ifndef INIT_DBSCAN_MEASURE
+#define INIT_DBSCAN_MEASURE STATIC_DBSCAN_MALLOC
+#endif
+
+#ifndef DBSCAN_MAX_NUM
+#define DBSCAN_MAX_NUM (4096)	/* STATIC时每份工作存储的点数 */
+#endif
+
+#define PDW_AOS 1
+#define PDW_SOA 2
+
+#ifndef PDW_LAYOUT
+#define PDW_LAYOUT PDW_AOS
+#endif
+
+/*
+ * DBSCAN_COMPACT为1时压缩每个点的工作状态，使一帧的工作集留在cache中:
+ *     visited为8位，类编号为16位有符号数(每帧最多32767个点);
+ *     点序号默认为16位(见nbr_index.h中的DBSCAN_INDEX_BITS);
+ *     待扩展队列改用点序号数组，不再使用int的deque.
+ */
+#ifndef DBSCAN_COMPACT
+#define DBSCAN_COMPACT 0
+#endif
+
+#if DBSCAN_COMPACT
+typedef unsigned char dbscan_state_t;
+typedef short dbscan_label_t;
+#define DBSCAN_LABEL_MAX (0x7FFF)
+#else
+typedef int dbscan_state_t;
+typedef int dbscan_label_t;
+#define DBSCAN_LABEL_MAX (0x7FFFFFFF)
+#endif
+
+/* 待扩展队列: 非紧凑的STATIC时为deque，否则为点序号数组 */
+#if INIT_DBSCAN_MEASURE == STATIC_DBSCAN_MALLOC && !DBSCAN_COMPACT \
+		&& DBSCAN_INDEX_BITS == 32
+#define DBSCAN_FLAT_QUEUE 0
+#else
+#define DBSCAN_FLAT_QUEUE 1
+#endif
+
+/* 每帧最多DBSCAN_MAX_NUM个点入队，静态的deque须能全部容纳，否则整批放入会失败 */
+#if !DBSCAN_FLAT_QUEUE && INIT_DEQUE_MEASURE == STATIC_DEQUE_MALLOC \
+		&& DBSCAN_MAX_NUM > DEQUE_MAX_NUM
+#error "DBSCAN_MAX_NUM exceeds DEQUE_MAX_NUM, the frontier deque can't hold a frame"
+#endif
+
+/*
+ * DBSCAN_DEDUP为1时，可在get_data()之后调用dbscan_dedup()，
+ * 把参与距离计算的各维(见metric.h)相同(或量化后相同)的点合并为一个带权重的点，
+ * 只对合并后的点聚类.
+ * 核心点按e领域内的权重之和判断，dbscan()结束时把结果写回每个原始点.
+ */
+#ifndef DBSCAN_DEDUP
+#define DBSCAN_DEDUP 0
+#endif
+
 typedef struct dbscan {
+#if PDW_LAYOUT == PDW_AOS
 	pdw_st *set;
-	int *major;		/* dbsacn聚类后，point_set中各项对应的类的编号  */
+	pdw_st *own_set;			/* 工作存储中的set，attach_data()后set指向外部的点 */
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	unsigned int *aoa;
+	unsigned int *freq;
+	unsigned int *pw;
+#endif
+
+	dbscan_label_t *major;		/* dbsacn聚类后，point_set中各项对应的类的编号  */
 	int ngroup;
 	unsigned int capacity;		/* point_set中数据的总数  */
-	int *visited;
+	dbscan_state_t *visited;
+	pt_index_t *new_nbrs;		/* search_nbr()的结果 */
+	unsigned int size;			/* 工作存储最多容纳的点数 */
 
 #define UNLABELED 0
 #define LABELED   1
@@ -37,17 +125,122 @@ typedef struct dbscan {
 #define EDGE      3
 #define NOISE     4
 
+#if INIT_DBSCAN_MEASURE == STATIC_DBSCAN_MALLOC
+	int slot;					/* 占用的工作存储 */
+#endif
+
+#if INIT_DBSCAN_MEASURE == DYNAMIC_DBSCAN_MALLOC
+	char *arena;				/* 全部工作存储 */
+#endif
+
+#if DBSCAN_FLAT_QUEUE
+	pt_index_t *queue;			/* 待扩展的点 */
+	unsigned int qhead;
+	unsigned int qtail;
+#else
 	struct deque finded_pts;
+#endif
+
+	struct nbr_index index;		/* e领域搜索索引，每次dbscan()时建立 */
+
+#if NBR_GRAPH
+	struct nbr_graph graph;		/* 全部点的e领域 */
+#endif
+
+#if DBSCAN_DEDUP
+	pt_index_t *weight;			/* 合并后的点代表的原始点数 */
+	pt_index_t *dedup_orig;		/* 各位置上的点的原始序号 */
+	pt_index_t *dedup_link;		/* 合并后的点: 散列桶中的下一个; 重复点: 所归并到的点 */
+	pt_index_t *dedup_head;		/* 散列桶 */
+	unsigned int nbucket;		/* 桶数，为2的幂 */
+	unsigned int npoint;		/* 合并前的点数，为0表示未合并 */
+#endif
+
+#if DBSCAN_PROF
+	struct dbscan_prof prof;	/* 最近一次get_data()/dbscan()的统计 */
+#endif
 }dbscan_st;
 
+/* 第i个点的各参数，与存放方式无关 */
+#if PDW_LAYOUT == PDW_AOS
+#define PDW_AOA(db, i)  ((db)->set[i].aoa)
+#define PDW_FREQ(db, i) ((db)->set[i].freq)
+#define PDW_PW(db, i)   ((db)->set[i].pw)
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+#define PDW_AOA(db, i)  ((db)->aoa[i])
+#define PDW_FREQ(db, i) ((db)->freq[i])
+#define PDW_PW(db, i)   ((db)->pw[i])
+#endif
+
+/* 第p1与第p2个点之间的距离是否不大于e，距离的定义见metric.h */
+static inline int pdw_within(const dbscan_st *db, int p1, int p2, unsigned int e)
+{
+	return metric_within(PDW_AOA(db, p1), PDW_FREQ(db, p1), PDW_PW(db, p1),
+			PDW_AOA(db, p2), PDW_FREQ(db, p2), PDW_PW(db, p2), e);
+}
+
+/* e领域内的点数，合并重复点后为权重之和 */
+static inline unsigned int nbr_weight(const dbscan_st *db, const pt_index_t *nbrs, int nnbr)
+{
+#if DBSCAN_DEDUP
+	unsigned int w = 0;
+	int k;
+
+	if (!db->npoint)
+		return nnbr;
+
+	for (k = 0; k < nnbr; ++k)
+		w += db->weight[nbrs[k]];
+
+	return w;
+#else
+	(void)db;
+	(void)nbrs;
+
+	return nnbr;
+#endif
+}
+
 int init_dbscan(dbscan_st *db, unsigned int num);
 
+int reset_dbscan(dbscan_st *db, unsigned int num);
+
 int get_data(dbscan_st *db, const ORIG_PDW *src);
 
+/*
+ * 代替get_data()，输入已按pdw_st存放的点(如映射的采集文件，见pdw_capture.h)，
+ * 点数为reset_dbscan()设置的capacity.
+ * PDW_AOS时直接引用set，不拷贝，set需在dbscan()结束前有效且可写:
+ * dbscan_dedup()会临时交换其中的点，dbscan()结束时恢复原来的顺序.
+ * PDW_SOA时拷贝到各维的数组中.
+ */
+int attach_data(dbscan_st *db, pdw_st *set);
+
+#if DBSCAN_DEDUP
+/*
+ * 合并重复点，q为各维的量化步长，为0时只合并完全相同的点.
+ * 合并后的点按首次出现的顺序排在前面，capacity变为合并后的点数，返回该点数.
+ */
+int dbscan_dedup(dbscan_st *db, unsigned int q);
+
+/* 把类编号写回重复点，并恢复各点原来的位置，dbscan()/dbscan_par()结束时调用 */
+void dbscan_scatter(dbscan_st *db);
+#endif
+
 void dbscan(dbscan_st *db, unsigned int e, unsigned int minpts);
 
 void del_dbscan(dbscan_st *db);
 
+#if DBSCAN_PROF
+void dbscan_get_prof(const dbscan_st *db, struct dbscan_prof *prof);
+#endif
+
+/*
+ * 按文本格式写到../simulate/dbscan_sim.txt，不可重入.
+ * 定义在dbscan_sink.c中，调用它的工程除dbscan.c外还需编译dbscan_sink.c.
+ */
 void print_dbscan_result(dbscan_st *db);
 
 #endif /* DBSCAN_H_ */
@@ -0,0 +1,247 @@
+/*
+ * dbscan_async.c
+ *
+ *  Created on: 2024-9-14
+ *      Author: xdu
+ */
+
+#include "dbscan_async.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SPIN_YIELD (64)		/* 等待时先让出CPU的次数，之后改为睡眠 */
+
+/* full_q中的特殊值 */
+#define MSG_END   (-1)
+#define MSG_FLUSH (-2)
+
+struct dbscan_async_slot {
+	dbscan_st view;			/* 只设置了PDW、major、capacity、ngroup，供next读取 */
+	unsigned int seq;
+	char *mem;
+};
+
+/* 先让出CPU，多次不成功后睡眠，空闲时不占满一个核 */
+static void backoff(int *spin)
+{
+	struct timespec t = { 0, 100000 };
+
+	if (++*spin < SPIN_YIELD)
+		sched_yield();
+	else
+		nanosleep(&t, NULL);
+}
+
+static void *writer(void *arg)
+{
+	struct dbscan_async_sink *s = (struct dbscan_async_sink *)arg;
+	struct dbscan_async_slot *slot;
+	int k, spin = 0;
+
+	for (;;) {
+		if (spsc_deque_pop_front(&s->full_q, &k) < 0) {
+			backoff(&spin);
+			continue;
+		}
+		spin = 0;
+
+		if (k == MSG_END)
+			break;
+
+		if (k == MSG_FLUSH) {
+			if (dbscan_sink_flush(s->next) < 0)
+				atomic_store(&s->err, 1);
+			continue;
+		}
+
+		slot = &s->slot[k];
+		if (dbscan_sink_write(s->next, &slot->view, slot->seq) < 0)
+			atomic_store(&s->err, 1);
+
+		/* free_q中最多nslot个槽，init时已保证放得下 */
+		spsc_deque_push_back(&s->free_q, k);
+	}
+
+	return NULL;
+}
+
+static int async_write(struct dbscan_sink *sink, const dbscan_st *db, unsigned int seq)
+{
+	struct dbscan_async_sink *s = (struct dbscan_async_sink *)sink;
+	struct dbscan_async_slot *slot;
+	dbscan_st *v;
+	unsigned int n = db->capacity;
+	int k, spin = 0;
+
+	if (n > s->max_npdw) {
+		printf("async sink: %u points exceed %u.\n", n, s->max_npdw);
+		return -1;
+	}
+
+	while (spsc_deque_pop_front(&s->free_q, &k) < 0) {
+		if (s->drop) {
+			++s->ndrop;
+			return 0;
+		}
+		backoff(&spin);
+	}
+
+	slot = &s->slot[k];
+	slot->seq = seq;
+	v = &slot->view;
+	v->capacity = n;
+	v->ngroup = db->ngroup;
+	memcpy(v->major, db->major, sizeof(db->major[0]) * n);
+
+	if (s->next->flags & DBSCAN_SINK_NEED_PDW) {
+#if PDW_LAYOUT == PDW_AOS
+		memcpy(v->set, db->set, sizeof(db->set[0]) * n);
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+		memcpy(v->aoa, db->aoa, sizeof(db->aoa[0]) * n);
+		memcpy(v->freq, db->freq, sizeof(db->freq[0]) * n);
+		memcpy(v->pw, db->pw, sizeof(db->pw[0]) * n);
+#endif
+	}
+
+	/* full_q中还可能有未处理的MSG_FLUSH，满时等待 */
+	while (spsc_deque_push_back(&s->full_q, k) < 0)
+		backoff(&spin);
+
+	return atomic_load(&s->err) ? -1 : 0;
+}
+
+static int async_flush(struct dbscan_sink *sink)
+{
+	struct dbscan_async_sink *s = (struct dbscan_async_sink *)sink;
+	int spin = 0;
+
+	while (spsc_deque_push_back(&s->full_q, MSG_FLUSH) < 0)
+		backoff(&spin);
+
+	return atomic_load(&s->err) ? -1 : 0;
+}
+
+static void free_slots(struct dbscan_async_sink *s)
+{
+	int k;
+
+	for (k = 0; k < s->nslot; ++k)
+		free(s->slot[k].mem);
+	free(s->slot);
+	s->slot = NULL;
+
+	spsc_deque_destroy(&s->full_q);
+	spsc_deque_destroy(&s->free_q);
+}
+
+static int async_close(struct dbscan_sink *sink)
+{
+	struct dbscan_async_sink *s = (struct dbscan_async_sink *)sink;
+	int ret, spin = 0;
+
+	while (spsc_deque_push_back(&s->full_q, MSG_END) < 0)
+		backoff(&spin);
+	pthread_join(s->thread, NULL);
+
+	ret = dbscan_sink_close(s->next);
+	if (atomic_load(&s->err))
+		ret = -1;
+
+	free_slots(s);
+
+	return ret;
+}
+
+/* 每个槽的类编号与PDW放在一块内存中，PDW按4字节对齐 */
+static int init_slot(struct dbscan_async_slot *slot, unsigned int num, int need_pdw)
+{
+	dbscan_st *v = &slot->view;
+	size_t label_bytes = (sizeof(dbscan_label_t) * (size_t)num + 3) & ~(size_t)3;
+	size_t pdw_bytes = need_pdw ? sizeof(pdw_st) * (size_t)num : 0;
+
+	memset(v, 0, sizeof(*v));
+	slot->mem = (char *)malloc(label_bytes + pdw_bytes + 1);
+	if (!slot->mem)
+		return -1;
+
+	v->major = (dbscan_label_t *)slot->mem;
+	if (!need_pdw)
+		return 0;
+
+#if PDW_LAYOUT == PDW_AOS
+	v->set = v->own_set = (pdw_st *)(slot->mem + label_bytes);
+#endif
+
+#if PDW_LAYOUT == PDW_SOA
+	v->aoa = (unsigned int *)(slot->mem + label_bytes);
+	v->freq = v->aoa + num;
+	v->pw = v->freq + num;
+#endif
+
+	return 0;
+}
+
+int dbscan_async_sink_init(struct dbscan_async_sink *s, struct dbscan_sink *next,
+		unsigned int max_npdw, int nslot, int drop)
+{
+	int k;
+
+	/* 所有槽须能同时放入free_q */
+	if (nslot > SPSC_MAX_NUM) {
+		printf("async sink: %d slots exceed %d.\n", nslot, SPSC_MAX_NUM);
+		return -1;
+	}
+
+	s->next = next;
+	s->nslot = nslot > 0 ? nslot : DBSCAN_ASYNC_NSLOT;
+	s->drop = drop;
+	s->max_npdw = max_npdw;
+	s->ndrop = 0;
+	atomic_init(&s->err, 0);
+
+	if (spsc_deque_init(&s->full_q) < 0)
+		return -1;
+	if (spsc_deque_init(&s->free_q) < 0) {
+		spsc_deque_destroy(&s->full_q);
+		return -1;
+	}
+
+	s->slot = (struct dbscan_async_slot *)calloc(s->nslot, sizeof(s->slot[0]));
+	if (!s->slot) {
+		printf("async sink: malloc slots failed.\n");
+		s->nslot = 0;
+		free_slots(s);
+		return -2;
+	}
+
+	for (k = 0; k < s->nslot; ++k) {
+		if (init_slot(&s->slot[k], max_npdw, next->flags & DBSCAN_SINK_NEED_PDW) < 0) {
+			printf("async sink: malloc slot of %u points failed.\n", max_npdw);
+			free_slots(s);
+			return -2;
+		}
+		if (spsc_deque_push_back(&s->free_q, k) < 0) {
+			printf("async sink: free queue is full.\n");
+			free_slots(s);
+			return -2;
+		}
+	}
+
+	s->base.write = async_write;
+	s->base.flush = async_flush;
+	s->base.close = async_close;
+	s->base.flags = next->flags;
+
+	if (pthread_create(&s->thread, NULL, writer, s) != 0) {
+		printf("async sink: create writer thread failed.\n");
+		free_slots(s);
+		return -3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * dbscan_async.h
+ *
+ *  Created on: 2024-9-14
+ *      Author: xdu
+ */
+
+#ifndef DBSCAN_ASYNC_H_
+#define DBSCAN_ASYNC_H_
+
+#include "dbscan_sink.h"
+#include "spsc_deque.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*
+ * 异步写出: dbscan_sink_write()只把结果拷贝到一个空闲槽中，经spsc_deque交给写出线程，
+ * 由写出线程调用next，聚类线程不等待文件I/O.
+ * 只拷贝类编号，next需要PDW(DBSCAN_SINK_NEED_PDW)时才拷贝各点的PDW.
+ * 写出线程落后nslot帧时，drop为0则等待空闲槽，为1则丢弃该帧并计入ndrop.
+ * flush只通知写出线程，不等待写出(队列满时等待入队); close时写完全部帧，并关闭next.
+ */
+#define DBSCAN_ASYNC_NSLOT (4)
+
+struct dbscan_async_slot;
+
+struct dbscan_async_sink {
+	struct dbscan_sink base;
+	struct dbscan_sink *next;	/* 实际写出的sink */
+	struct dbscan_async_slot *slot;
+	int nslot;
+	int drop;
+	unsigned int max_npdw;		/* 每帧最多的点数 */
+
+	struct spsc_deque full_q;	/* 待写出的槽 */
+	struct spsc_deque free_q;	/* 空闲的槽 */
+	pthread_t thread;
+
+	atomic_int err;				/* next出错后为1 */
+	unsigned long long ndrop;	/* 丢弃的帧数 */
+};
+
+/* nslot为0时取DBSCAN_ASYNC_NSLOT，不能超过SPSC_MAX_NUM */
+int dbscan_async_sink_init(struct dbscan_async_sink *s, struct dbscan_sink *next,
+		unsigned int max_npdw, int nslot, int drop);
+
+#endif /* DBSCAN_ASYNC_H_ */
@@ -0,0 +1,510 @@
+/*
+ * dbscan_par.c
+ *
+ *  Created on: 2024-8-5
+ *      Author: xdu
+ */
+
+#include "dbscan_par.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+
+#define CHUNK (64)
+
+struct dbscan_par_arg {
+	dbscan_par_st *par;
+	int tid;
+#if DBSCAN_PROF
+	unsigned long long ndist;	/* 本线程的距离计算次数 */
+#endif
+};
+
+/*
+ * e领域搜索. DBSCAN_PROF时各线程的距离计算次数记在run()的局部变量中，
+ * 最后一个屏障之前存入args[tid]，由dbscan_par()求和，不争抢db->prof.
+ */
+#if DBSCAN_PROF
+#define NDIST_DECL(n)				unsigned long long n = 0
+#define NDIST_PTR(n)				(&(n))
+#define NDIST_SAVE(par, tid, n)		((par)->args[tid].ndist = (n))
+#define SEARCH(par, i, nbrs, ndist)	nbr_index_search_count((par)->db, i, (par)->e, nbrs, ndist)
+#else
+#define NDIST_DECL(n)
+#define NDIST_PTR(n)				NULL
+#define NDIST_SAVE(par, tid, n)		((void)0)
+#define SEARCH(par, i, nbrs, ndist)	nbr_index_search((par)->db, i, (par)->e, nbrs)
+#endif
+
+/* 从阶段计数器中领取一段点，返回起点，end为终点 */
+static inline int next_chunk(atomic_int *next, int n, int *end)
+{
+	int begin = atomic_fetch_add_explicit(next, CHUNK, memory_order_relaxed);
+
+	*end = begin + CHUNK < n ? begin + CHUNK : n;
+
+	return begin;
+}
+
+#if DBSCAN_PAR_MEASURE == PAR_UNION_FIND
+static int find(atomic_int *parent, int x)
+{
+	int p, gp;
+
+	while ((p = atomic_load_explicit(&parent[x], memory_order_relaxed)) != x) {
+		gp = atomic_load_explicit(&parent[p], memory_order_relaxed);
+
+		/* 路径折半，parent只会变小，失败也无妨 */
+		if (gp != p)
+			atomic_compare_exchange_weak(&parent[x], &p, gp);
+
+		x = gp;
+	}
+
+	return x;
+}
+
+static void unite(atomic_int *parent, int a, int b)
+{
+	int t;
+
+	for (;;) {
+		a = find(parent, a);
+		b = find(parent, b);
+
+		if (a == b)
+			return;
+
+		/* 序号大的根挂到序号小的根下，根始终是集合中序号最小的点 */
+		if (a < b) {
+			t = a;
+			a = b;
+			b = t;
+		}
+
+		t = a;
+		if (atomic_compare_exchange_strong(&parent[a], &t, b))
+			return;
+	}
+}
+
+static void run(dbscan_par_st *par, int tid)
+{
+	dbscan_st *db = par->db;
+	int n = db->capacity;
+	pt_index_t *nbrs = par->nbrs + (size_t)tid * par->num;
+	int i, j, k, end, nnbr, g, best;
+	NDIST_DECL(ndist);
+
+	/* 阶段1: 核心点 */
+	while ((i = next_chunk(&par->next[0], n, &end)) < n) {
+		for (; i < end; ++i) {
+			nnbr = SEARCH(par, i, nbrs, NDIST_PTR(ndist));
+			par->core[i] = nbr_weight(db, nbrs, nnbr) >= par->minpts;
+			atomic_store_explicit(&par->parent[i], i, memory_order_relaxed);
+		}
+	}
+
+	pthread_barrier_wait(&par->barrier);
+
+	/* 阶段2: 合并e领域内的核心点，每条边只处理一次 */
+	while ((i = next_chunk(&par->next[1], n, &end)) < n) {
+		for (; i < end; ++i) {
+			if (!par->core[i])
+				continue;
+
+			nnbr = SEARCH(par, i, nbrs, NDIST_PTR(ndist));
+			for (k = 0; k < nnbr; ++k) {
+				j = nbrs[k];
+
+				if (j < i && par->core[j])
+					unite(par->parent, i, j);
+			}
+		}
+	}
+
+	pthread_barrier_wait(&par->barrier);
+
+	/* 按根的序号依次编号，与dbscan()外层循环找到各类的顺序一致 */
+	if (tid == 0) {
+		g = 0;
+		for (i = 0; i < n; ++i) {
+			if (par->core[i] && find(par->parent, i) == i)
+				par->label[i] = ++g;
+		}
+
+		db->ngroup = g;
+	}
+
+	pthread_barrier_wait(&par->barrier);
+
+	/* 阶段3: 核心点取所在集合的编号，非核心点取e领域内最小的编号 */
+	while ((i = next_chunk(&par->next[2], n, &end)) < n) {
+		for (; i < end; ++i) {
+			if (par->core[i]) {
+				db->major[i] = par->label[find(par->parent, i)];
+				db->visited[i] = LABELED;
+				continue;
+			}
+
+			best = -1;
+			nnbr = SEARCH(par, i, nbrs, NDIST_PTR(ndist));
+			for (k = 0; k < nnbr; ++k) {
+				j = nbrs[k];
+
+				if (!par->core[j])
+					continue;
+
+				g = par->label[find(par->parent, j)];
+				if (best < 0 || g < best)
+					best = g;
+			}
+
+			db->major[i] = best;
+			db->visited[i] = best < 0 ? EDGE : LABELED;
+		}
+	}
+
+	NDIST_SAVE(par, tid, ndist);
+	pthread_barrier_wait(&par->barrier);
+}
+#endif
+
+#if DBSCAN_PAR_MEASURE == PAR_WORK_STEALING
+/* 依次从其他线程的队列顶部窃取 */
+static int steal(dbscan_par_st *par, int tid, int *j)
+{
+	int k, r;
+
+	for (k = 1; k < par->nthreads; ++k) {
+		do {
+			r = ws_deque_steal(&par->ws[(tid + k) % par->nthreads], j);
+		} while (r == WS_ABORT);
+
+		if (r == 0)
+			return 0;
+	}
+
+	return -1;
+}
+
+/* 核心点j的e领域内尚未归类的点归入j所在的类，其中的核心点入队继续扩展 */
+static void expand_point(dbscan_par_st *par, int tid, int j, pt_index_t *nbrs,
+		int *nspill, unsigned long long *ndist)
+{
+	int g = atomic_load_explicit(&par->claim[j], memory_order_relaxed);
+	int *spill = par->spill + (size_t)tid * par->num;
+	int k, p, nnbr, free;
+
+	nnbr = SEARCH(par, j, nbrs, ndist);
+	for (k = 0; k < nnbr; ++k) {
+		p = nbrs[k];
+		free = 0;
+
+		if (atomic_load_explicit(&par->claim[p], memory_order_relaxed) != 0
+				|| !atomic_compare_exchange_strong(&par->claim[p], &free, g))
+			continue;
+
+		if (!par->core[p])
+			continue;
+
+		/* 先计数再入队，pending为0时所有点都已扩展完 */
+		atomic_fetch_add_explicit(&par->pending, 1, memory_order_relaxed);
+		if (ws_deque_push(&par->ws[tid], p) < 0)
+			spill[(*nspill)++] = p;
+	}
+
+	atomic_fetch_sub_explicit(&par->pending, 1, memory_order_release);
+}
+
+/* 扩展当前的类，自己和其他线程都没有可取的点时返回 */
+static void expand(dbscan_par_st *par, int tid, pt_index_t *nbrs, unsigned long long *ndist)
+{
+	int *spill = par->spill + (size_t)tid * par->num;
+	int nspill = 0, j;
+
+	for (;;) {
+		if (ws_deque_pop(&par->ws[tid], &j) == 0)
+			;
+		else if (nspill > 0)
+			j = spill[--nspill];
+		else if (steal(par, tid, &j) < 0)
+			return;
+
+		expand_point(par, tid, j, nbrs, &nspill, ndist);
+	}
+}
+
+static void run(dbscan_par_st *par, int tid)
+{
+	dbscan_st *db = par->db;
+	int n = db->capacity;
+	pt_index_t *nbrs = par->nbrs + (size_t)tid * par->num;
+	int i, end, g, c, nnbr;
+	NDIST_DECL(ndist);
+
+	ws_deque_clear(&par->ws[tid]);
+
+	/* 阶段1: 核心点 */
+	while ((i = next_chunk(&par->next[0], n, &end)) < n) {
+		for (; i < end; ++i) {
+			nnbr = SEARCH(par, i, nbrs, NDIST_PTR(ndist));
+			par->core[i] = nbr_weight(db, nbrs, nnbr) >= par->minpts;
+			atomic_store_explicit(&par->claim[i], 0, memory_order_relaxed);
+		}
+	}
+
+	pthread_barrier_wait(&par->barrier);
+
+	/* 阶段2: 0号线程按序号依次确定各类的起点，类编号与dbscan()外层循环一致 */
+	if (tid == 0) {
+		g = 0;
+		for (i = 0; i < n; ++i) {
+			if (!par->core[i] || atomic_load_explicit(&par->claim[i], memory_order_acquire))
+				continue;
+
+			atomic_store_explicit(&par->claim[i], ++g, memory_order_relaxed);
+			atomic_store_explicit(&par->pending, 1, memory_order_relaxed);
+			ws_deque_push(&par->ws[0], i);
+
+			/* 本类扩展完之前不开始下一类，边界点归入最先到达的类 */
+			while (atomic_load_explicit(&par->pending, memory_order_acquire) != 0) {
+				expand(par, 0, nbrs, NDIST_PTR(ndist));
+				sched_yield();
+			}
+		}
+
+		db->ngroup = g;
+		atomic_store_explicit(&par->done, 1, memory_order_release);
+	} else {
+		while (!atomic_load_explicit(&par->done, memory_order_acquire)) {
+			expand(par, tid, nbrs, NDIST_PTR(ndist));
+			sched_yield();
+		}
+	}
+
+	pthread_barrier_wait(&par->barrier);
+
+	/* 阶段3: 写回结果，未归类的点为噪声 */
+	while ((i = next_chunk(&par->next[2], n, &end)) < n) {
+		for (; i < end; ++i) {
+			c = atomic_load_explicit(&par->claim[i], memory_order_relaxed);
+			db->major[i] = c ? c : -1;
+			db->visited[i] = c ? LABELED : EDGE;
+		}
+	}
+
+	NDIST_SAVE(par, tid, ndist);
+	pthread_barrier_wait(&par->barrier);
+}
+#endif
+
+static void *worker(void *arg)
+{
+	struct dbscan_par_arg *a = (struct dbscan_par_arg *)arg;
+	dbscan_par_st *par = a->par;
+	unsigned int generation = 0;
+
+	for (;;) {
+		pthread_mutex_lock(&par->lock);
+		while (par->generation == generation && !par->quit)
+			pthread_cond_wait(&par->start, &par->lock);
+
+		generation = par->generation;
+		if (par->quit) {
+			pthread_mutex_unlock(&par->lock);
+			break;
+		}
+		pthread_mutex_unlock(&par->lock);
+
+		run(par, a->tid);
+	}
+
+	return NULL;
+}
+
+#if DBSCAN_PAR_MEASURE == PAR_UNION_FIND
+static int alloc_work(dbscan_par_st *par)
+{
+	unsigned int num = par->num ? par->num : 1;
+
+	par->parent = (atomic_int *)malloc(sizeof(atomic_int) * num);
+	par->label = (int *)malloc(sizeof(int) * num);
+
+	return par->parent && par->label ? 0 : -1;
+}
+
+static void free_work(dbscan_par_st *par)
+{
+	free(par->parent);
+	free(par->label);
+}
+#endif
+
+#if DBSCAN_PAR_MEASURE == PAR_WORK_STEALING
+static int alloc_work(dbscan_par_st *par)
+{
+	unsigned int num = par->num ? par->num : 1;
+	int i;
+
+	par->ws = (struct ws_deque *)aligned_alloc(WS_CACHE_LINE,
+			sizeof(struct ws_deque) * par->nthreads);
+	par->spill = (int *)malloc(sizeof(int) * (size_t)num * par->nthreads);
+	par->claim = (atomic_int *)malloc(sizeof(atomic_int) * num);
+
+	if (par->ws) {
+		for (i = 0; i < par->nthreads; ++i)
+			par->ws[i].data = NULL;
+	}
+
+	if (!par->ws || !par->spill || !par->claim)
+		return -1;
+
+	for (i = 0; i < par->nthreads; ++i) {
+		if (ws_deque_init(&par->ws[i]) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+static void free_work(dbscan_par_st *par)
+{
+	int i;
+
+	if (par->ws) {
+		for (i = 0; i < par->nthreads; ++i) {
+			if (par->ws[i].data)
+				ws_deque_destroy(&par->ws[i]);
+		}
+	}
+
+	free(par->ws);
+	free(par->spill);
+	free(par->claim);
+}
+#endif
+
+/* 通知已启动的1 ~ n-1号线程退出并等待 */
+static void stop_threads(dbscan_par_st *par, int n)
+{
+	int i;
+
+	pthread_mutex_lock(&par->lock);
+	par->quit = 1;
+	pthread_cond_broadcast(&par->start);
+	pthread_mutex_unlock(&par->lock);
+
+	for (i = 1; i < n; ++i)
+		pthread_join(par->threads[i], NULL);
+}
+
+static void free_all(dbscan_par_st *par)
+{
+	pthread_barrier_destroy(&par->barrier);
+	pthread_cond_destroy(&par->start);
+	pthread_mutex_destroy(&par->lock);
+
+	free(par->threads);
+	free(par->args);
+	free(par->nbrs);
+	free(par->core);
+	free_work(par);
+}
+
+int init_dbscan_par(dbscan_par_st *par, int nthreads, unsigned int num)
+{
+	int i, ret;
+
+	if (nthreads < 1)
+		nthreads = 1;
+
+	par->nthreads = nthreads;
+	par->num = num;
+	par->generation = 0;
+	par->quit = 0;
+
+	par->threads = (pthread_t *)malloc(sizeof(pthread_t) * nthreads);
+	par->args = (struct dbscan_par_arg *)malloc(sizeof(struct dbscan_par_arg) * nthreads);
+	par->nbrs = (pt_index_t *)malloc(sizeof(pt_index_t) * (size_t)num * nthreads);
+	par->core = (unsigned char *)malloc(num ? num : 1);
+	ret = alloc_work(par);
+
+	if (!par->threads || !par->args || !par->nbrs || !par->core || ret < 0) {
+		printf("init_dbscan_par: malloc failed.\n");
+		free(par->threads);
+		free(par->args);
+		free(par->nbrs);
+		free(par->core);
+		free_work(par);
+		return -1;
+	}
+
+	pthread_mutex_init(&par->lock, NULL);
+	pthread_cond_init(&par->start, NULL);
+	pthread_barrier_init(&par->barrier, NULL, nthreads);
+
+	/* 调用线程作为0号线程参与计算 */
+	for (i = 0; i < nthreads; ++i) {
+		par->args[i].par = par;
+		par->args[i].tid = i;
+
+		/* 少一个线程时屏障永远等不齐，只能全部退出 */
+		if (i > 0 && pthread_create(&par->threads[i], NULL, worker, &par->args[i]) != 0) {
+			printf("init_dbscan_par: create thread %d failed.\n", i);
+			stop_threads(par, i);
+			free_all(par);
+			return -2;
+		}
+	}
+
+	return 0;
+}
+
+void dbscan_par(dbscan_par_st *par, dbscan_st *db, unsigned int e, unsigned int minpts)
+{
+#if DBSCAN_PROF
+	int i;
+#endif
+
+	if (db->capacity > par->num) {
+		printf("dbscan_par: %u points exceed %u.\n", db->capacity, par->num);
+		return;
+	}
+
+	nbr_index_build(db, e);
+
+	pthread_mutex_lock(&par->lock);
+	par->db = db;
+	par->e = e;
+	par->minpts = minpts;
+	atomic_store(&par->next[0], 0);
+	atomic_store(&par->next[1], 0);
+	atomic_store(&par->next[2], 0);
+#if DBSCAN_PAR_MEASURE == PAR_WORK_STEALING
+	atomic_store(&par->pending, 0);
+	atomic_store(&par->done, 0);
+#endif
+	++par->generation;
+	pthread_cond_broadcast(&par->start);
+	pthread_mutex_unlock(&par->lock);
+
+	run(par, 0);
+
+#if DBSCAN_PROF
+	/* 各线程已过最后一个屏障，计数都已存入 */
+	db->prof.ndist = 0;
+	for (i = 0; i < par->nthreads; ++i)
+		db->prof.ndist += par->args[i].ndist;
+#endif
+
+#if DBSCAN_DEDUP
+	dbscan_scatter(db);
+#endif
+}
+
+void del_dbscan_par(dbscan_par_st *par)
+{
+	stop_threads(par, par->nthreads);
+	free_all(par);
+}
@@ -0,0 +1,78 @@
+/*
+ * dbscan_par.h
+ *
+ *  Created on: 2024-8-5
+ *      Author: xdu
+ */
+
+#ifndef DBSCAN_PAR_H_
+#define DBSCAN_PAR_H_
+
+#include "dbscan.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define PAR_UNION_FIND 1
+#define PAR_WORK_STEALING 2
+
+/*
+ * 多线程dbscan，先并行计算每个点的e领域点数，确定核心点，再按以下方式之一聚类:
+ * PAR_UNION_FIND
+ *     1. e领域内的核心点两两合并(无锁并查集)，每个集合为一类;
+ *     2. 非核心点归入e领域内编号最小的类，没有则为噪声.
+ * PAR_WORK_STEALING
+ *     0号线程按序号寻找未归类的核心点作为新类的起点，各类依次扩展;
+ *     扩展时每个线程从自己的工作窃取队列底部取点，空闲的线程从其他队列顶部窃取，
+ *     点用CAS归类，一个大类的扩展分摊到所有线程.
+ * 结果(类编号及其顺序)与dbscan()相同.
+ */
+#ifndef DBSCAN_PAR_MEASURE
+#define DBSCAN_PAR_MEASURE PAR_UNION_FIND
+#endif
+
+#if DBSCAN_PAR_MEASURE == PAR_WORK_STEALING
+#include "ws_deque.h"
+#endif
+
+typedef struct dbscan_par {
+	int nthreads;				/* 线程数，含调用线程 */
+	pthread_t *threads;
+	struct dbscan_par_arg *args;
+
+	pthread_mutex_t lock;
+	pthread_cond_t start;
+	pthread_barrier_t barrier;
+	unsigned int generation;	/* 每提交一次任务加一 */
+	int quit;
+
+	/* 当前任务 */
+	dbscan_st *db;
+	unsigned int e;
+	unsigned int minpts;
+	atomic_int next[3];			/* 各阶段下一个待处理的点 */
+
+	unsigned int num;			/* 最多支持的点数 */
+	pt_index_t *nbrs;			/* 每个线程num个，e领域搜索结果 */
+	unsigned char *core;		/* 是否为核心点 */
+
+#if DBSCAN_PAR_MEASURE == PAR_UNION_FIND
+	atomic_int *parent;			/* 并查集，根为集合中序号最小的点 */
+	int *label;					/* 根对应的类编号 */
+#endif
+
+#if DBSCAN_PAR_MEASURE == PAR_WORK_STEALING
+	struct ws_deque *ws;		/* 每个线程一个 */
+	int *spill;					/* 每个线程num个，队列满时存放待扩展的点 */
+	atomic_int *claim;			/* 点所属的类，0为尚未归类 */
+	atomic_int pending;			/* 已入队尚未扩展完的点数 */
+	atomic_int done;			/* 所有类扩展完毕 */
+#endif
+}dbscan_par_st;
+
+int init_dbscan_par(dbscan_par_st *par, int nthreads, unsigned int num);
+
+void dbscan_par(dbscan_par_st *par, dbscan_st *db, unsigned int e, unsigned int minpts);
+
+void del_dbscan_par(dbscan_par_st *par);
+
+#endif /* DBSCAN_PAR_H_ */
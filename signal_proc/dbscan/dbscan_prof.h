@@ -0,0 +1,51 @@
+/*
+ * dbscan_prof.h
+ *
+ *  Created on: 2024-9-9
+ *      Author: xdu
+ */
+
+#ifndef DBSCAN_PROF_H_
+#define DBSCAN_PROF_H_
+
+/*
+ * DBSCAN_PROF为1时，每次get_data()/dbscan()记录各阶段的周期数(见cycle_timer.h)和计数，
+ * 用dbscan_get_prof()读出. 为0时下面的宏全部为空，不产生任何代码.
+ * dbscan_par()只统计ndist: 各线程分别计数，结束时求和.
+ */
+#ifndef DBSCAN_PROF
+#define DBSCAN_PROF 0
+#endif
+
+#if DBSCAN_PROF
+#include "cycle_timer.h"
+
+struct dbscan_prof {
+	cycle_t get_data;			/* get_data() */
+	cycle_t search;				/* 建立索引和e领域搜索 */
+	cycle_t expand;				/* dbscan()中除搜索以外的部分，即扩展类 */
+	unsigned long long ndist;	/* 距离计算次数 */
+	unsigned int queue_peak;	/* 待扩展队列的最大长度 */
+	int ncluster;
+	int nnoise;
+};
+
+#define PROF_DECL(t)			cycle_t t
+#define PROF_START(t)			((t) = cycle_now())
+#define PROF_STOP(db, field, t)	((db)->prof.field += cycle_now() - (t))
+#define PROF_ADD(db, field, n)	((db)->prof.field += (n))
+#define PROF_MAX(db, field, v) \
+do { \
+	if ((v) > (db)->prof.field) \
+		(db)->prof.field = (v); \
+} while (0)
+
+#else
+#define PROF_DECL(t)
+#define PROF_START(t)			((void)0)
+#define PROF_STOP(db, field, t)	((void)0)
+#define PROF_ADD(db, field, n)	((void)0)
+#define PROF_MAX(db, field, v)	((void)0)
+#endif
+
+#endif /* DBSCAN_PROF_H_ */
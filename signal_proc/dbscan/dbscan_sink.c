@@ -0,0 +1,379 @@
+/*
+ * dbscan_sink.c
+ *
+ *  Created on: 2024-9-14
+ *      Author: xdu
+ */
+
+#include "dbscan_sink.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_BUFSIZE  DBSCAN_SINK_MIN_BUFSIZE
+#define LABEL_CHUNK  (1024)			/* 每次打包的类编号个数，4字节时正好MIN_BUFSIZE */
+#define TEXT_ROW_MAX (128)			/* 一行文本的最大长度 */
+
+/* buf为NULL时申请cap字节并关闭stdio的缓冲，否则使用调用者的buf */
+static int buf_open(struct dbscan_sink_buf *b, const char *path, const char *mode,
+		char *buf, size_t cap)
+{
+	if (buf && cap < MIN_BUFSIZE) {
+		printf("sink: buffer of %zu bytes is less than %d.\n", cap, MIN_BUFSIZE);
+		return -1;
+	}
+
+	b->fp = fopen(path, mode);
+	if (!b->fp) {
+		printf("sink: can't open %s.\n", path);
+		return -1;
+	}
+
+	b->len = 0;
+	b->err = 0;
+
+	if (buf) {
+		b->buf = buf;
+		b->cap = cap;
+		b->own = 0;
+		return 0;
+	}
+
+	/* 已在大缓冲区中缓冲，关闭stdio的缓冲，少拷贝一次 */
+	setvbuf(b->fp, NULL, _IONBF, 0);
+
+	b->cap = cap ? cap : DBSCAN_SINK_BUFSIZE;
+	if (b->cap < MIN_BUFSIZE)
+		b->cap = MIN_BUFSIZE;
+
+	b->buf = (char *)malloc(b->cap);
+	if (!b->buf) {
+		printf("sink: malloc %zu bytes failed.\n", b->cap);
+		fclose(b->fp);
+		b->fp = NULL;
+		return -2;
+	}
+	b->own = 1;
+
+	return 0;
+}
+
+/* 把缓冲区中的数据写入文件 */
+static void buf_drain(struct dbscan_sink_buf *b)
+{
+	if (b->len && fwrite(b->buf, 1, b->len, b->fp) != b->len)
+		b->err = 1;
+	b->len = 0;
+}
+
+/* 保证缓冲区至少还有n字节空闲，返回写入位置，n不大于MIN_BUFSIZE */
+static inline char *buf_reserve(struct dbscan_sink_buf *b, size_t n)
+{
+	if (b->cap - b->len < n)
+		buf_drain(b);
+
+	return b->buf + b->len;
+}
+
+static int buf_flush(struct dbscan_sink_buf *b)
+{
+	buf_drain(b);
+	if (fflush(b->fp) != 0)
+		b->err = 1;
+
+	return b->err ? -1 : 0;
+}
+
+static int buf_close(struct dbscan_sink_buf *b)
+{
+	int ret = buf_flush(b);
+
+	if (fclose(b->fp) != 0)
+		ret = -1;
+	if (b->own)
+		free(b->buf);
+	b->fp = NULL;
+	b->buf = NULL;
+
+	return ret;
+}
+
+/* 类1~ngroup的点数与各维之和，sum按ngroup扩大，超出ngroup的编号不计入 */
+static int bin_summary(struct dbscan_bin_sink *s, const dbscan_st *db, unsigned int ngroup)
+{
+	unsigned long long *sum;
+	int i, g;
+
+	if (ngroup > s->nsum) {
+		sum = (unsigned long long *)realloc(s->sum, sizeof(sum[0]) * 4 * ngroup);
+		if (!sum) {
+			printf("sink: malloc summary of %u clusters failed.\n", ngroup);
+			return -1;
+		}
+		s->sum = sum;
+		s->nsum = ngroup;
+	}
+
+	sum = s->sum;
+	memset(sum, 0, sizeof(sum[0]) * 4 * ngroup);
+
+	for (i = 0; i < db->capacity; ++i) {
+		/* 类编号从1开始 */
+		g = db->major[i] - 1;
+		if (g < 0 || (unsigned int)g >= ngroup)
+			continue;
+
+		sum[4 * g] += 1;
+		sum[4 * g + 1] += PDW_AOA(db, i);
+		sum[4 * g + 2] += PDW_FREQ(db, i);
+		sum[4 * g + 3] += PDW_PW(db, i);
+	}
+
+	return 0;
+}
+
+static inline int label(int g)
+{
+	return g < 0 ? 0 : g;
+}
+
+/* 类编号按w字节打包，噪声(-1)记为0 */
+static void bin_labels(struct dbscan_sink_buf *b, const dbscan_st *db, unsigned int w)
+{
+	static const char zero[4];
+	unsigned int i, k, n, pad;
+	char *p;
+
+	for (i = 0; i < db->capacity; i += n) {
+		n = db->capacity - i < LABEL_CHUNK ? db->capacity - i : LABEL_CHUNK;
+		p = buf_reserve(b, n * w);
+
+		if (w == 1) {
+			for (k = 0; k < n; ++k)
+				((unsigned char *)p)[k] = (unsigned char)label(db->major[i + k]);
+		} else if (w == 2) {
+			for (k = 0; k < n; ++k)
+				((unsigned short *)p)[k] = (unsigned short)label(db->major[i + k]);
+		} else {
+			for (k = 0; k < n; ++k)
+				((unsigned int *)p)[k] = (unsigned int)label(db->major[i + k]);
+		}
+
+		b->len += n * w;
+	}
+
+	pad = (0u - db->capacity * w) & 3;
+	memcpy(buf_reserve(b, pad), zero, pad);
+	b->len += pad;
+}
+
+static int bin_write(struct dbscan_sink *sink, const dbscan_st *db, unsigned int seq)
+{
+	struct dbscan_bin_sink *s = (struct dbscan_bin_sink *)sink;
+	struct dbscan_rec rec;
+	struct dbscan_rec_cluster c;
+	unsigned long long *sum;
+	unsigned int ngroup = 0;
+	int i;
+
+	memset(&rec, 0, sizeof(rec));
+	rec.magic = DBSCAN_REC_MAGIC;
+	rec.seq = seq;
+	rec.npdw = db->capacity;
+
+	/* 类编号的最大值，dbscan_stream等的编号可能不连续，大于db->ngroup */
+	for (i = 0; i < db->capacity; ++i) {
+		if (db->major[i] < 0)
+			++rec.nnoise;
+		else if ((unsigned int)db->major[i] > ngroup)
+			ngroup = db->major[i];
+	}
+	rec.ngroup = ngroup;
+
+	if (s->what & DBSCAN_BIN_SUMMARY) {
+		if (bin_summary(s, db, ngroup) < 0)
+			return -1;
+		rec.summary = 1;
+	}
+
+	if (s->what & DBSCAN_BIN_LABELS)
+		rec.label_bytes = ngroup <= 0xFF ? 1 : ngroup <= 0xFFFF ? 2 : 4;
+
+	memcpy(buf_reserve(&s->out, sizeof(rec)), &rec, sizeof(rec));
+	s->out.len += sizeof(rec);
+
+	if (rec.summary) {
+		for (i = 0, sum = s->sum; i < (int)ngroup; ++i, sum += 4) {
+			/* 未使用的编号各项为0 */
+			memset(&c, 0, sizeof(c));
+			if (sum[0]) {
+				c.count = (unsigned int)sum[0];
+				c.aoa = (unsigned int)(sum[1] / sum[0]);
+				c.freq = (unsigned int)(sum[2] / sum[0]);
+				c.pw = (unsigned int)(sum[3] / sum[0]);
+			}
+
+			memcpy(buf_reserve(&s->out, sizeof(c)), &c, sizeof(c));
+			s->out.len += sizeof(c);
+		}
+	}
+
+	if (rec.label_bytes)
+		bin_labels(&s->out, db, rec.label_bytes);
+
+	return s->out.err ? -1 : 0;
+}
+
+static int bin_flush(struct dbscan_sink *sink)
+{
+	return buf_flush(&((struct dbscan_bin_sink *)sink)->out);
+}
+
+static int bin_close(struct dbscan_sink *sink)
+{
+	struct dbscan_bin_sink *s = (struct dbscan_bin_sink *)sink;
+
+	free(s->sum);
+	s->sum = NULL;
+	s->nsum = 0;
+
+	return buf_close(&s->out);
+}
+
+int dbscan_bin_sink_init(struct dbscan_bin_sink *s, const char *path, unsigned int what,
+		size_t bufsize)
+{
+	if (buf_open(&s->out, path, "wb", NULL, bufsize) < 0)
+		return -1;
+
+	s->base.write = bin_write;
+	s->base.flush = bin_flush;
+	s->base.close = bin_close;
+	s->base.flags = (what & DBSCAN_BIN_SUMMARY) ? DBSCAN_SINK_NEED_PDW : 0;
+	s->what = what;
+	s->sum = NULL;
+	s->nsum = 0;
+
+	return 0;
+}
+
+/* 按"%-wd"的格式写入v，返回之后的位置 */
+static inline char *put_int(char *p, int v, int width)
+{
+	char tmp[12];
+	unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+	int n = 0, len;
+
+	do {
+		tmp[n++] = (char)('0' + u % 10);
+		u /= 10;
+	} while (u);
+
+	if (v < 0)
+		tmp[n++] = '-';
+
+	for (len = n; n > 0; )
+		*p++ = tmp[--n];
+	for (; len < width; ++len)
+		*p++ = ' ';
+
+	return p;
+}
+
+static void put_str(struct dbscan_sink_buf *b, const char *str)
+{
+	size_t n = strlen(str);
+
+	memcpy(buf_reserve(b, n), str, n);
+	b->len += n;
+}
+
+#define TEXT_RULE \
+	"---------------------------------------------------------------------------------------------\n"
+
+static int text_write(struct dbscan_sink *sink, const dbscan_st *db, unsigned int seq)
+{
+	struct dbscan_sink_buf *b = &((struct dbscan_text_sink *)sink)->out;
+	char *p;
+	int i;
+
+	(void)seq;
+
+	put_str(b, TEXT_RULE);
+	put_str(b, "num                   PW                   FC                   AOA                   cluster\n");
+	put_str(b, TEXT_RULE);
+
+	/* 与原来的fprintf("%-21d %-20d %-20d %-21d %-7d\n")输出相同 */
+	for (i = 0; i < db->capacity; ++i) {
+		p = buf_reserve(b, TEXT_ROW_MAX);
+		p = put_int(p, i, 21);
+		*p++ = ' ';
+		p = put_int(p, (int)PDW_PW(db, i), 20);
+		*p++ = ' ';
+		p = put_int(p, (int)PDW_FREQ(db, i), 20);
+		*p++ = ' ';
+		p = put_int(p, (int)PDW_AOA(db, i), 21);
+		*p++ = ' ';
+		p = put_int(p, db->major[i], 7);
+		*p++ = '\n';
+		b->len = p - b->buf;
+	}
+
+	put_str(b, TEXT_RULE "\n");
+
+	return b->err ? -1 : 0;
+}
+
+static int text_flush(struct dbscan_sink *sink)
+{
+	return buf_flush(&((struct dbscan_text_sink *)sink)->out);
+}
+
+static int text_close(struct dbscan_sink *sink)
+{
+	return buf_close(&((struct dbscan_text_sink *)sink)->out);
+}
+
+static void text_init(struct dbscan_text_sink *s)
+{
+	s->base.write = text_write;
+	s->base.flush = text_flush;
+	s->base.close = text_close;
+	s->base.flags = DBSCAN_SINK_NEED_PDW;
+}
+
+int dbscan_text_sink_init(struct dbscan_text_sink *s, const char *path, size_t bufsize)
+{
+	if (buf_open(&s->out, path, "w", NULL, bufsize) < 0)
+		return -1;
+
+	text_init(s);
+
+	return 0;
+}
+
+int dbscan_text_sink_init_buf(struct dbscan_text_sink *s, const char *path, char *buf,
+		size_t size)
+{
+	if (buf_open(&s->out, path, "w", buf, size) < 0)
+		return -1;
+
+	text_init(s);
+
+	return 0;
+}
+
+/* print_dbscan_result()的缓冲区，放在栈上时C6x默认的栈可能不够; 因此该函数不可重入 */
+static char print_buf[DBSCAN_SINK_MIN_BUFSIZE];
+
+void print_dbscan_result(dbscan_st *db)
+{
+	struct dbscan_text_sink s;
+
+	/* 只写一帧，用静态的小缓冲区，不从堆上申请 */
+	if (dbscan_text_sink_init_buf(&s, "../simulate/dbscan_sim.txt", print_buf,
+			sizeof(print_buf)) < 0)
+		return;
+
+	dbscan_sink_write(&s.base, db, 0);
+	dbscan_sink_close(&s.base);
+}
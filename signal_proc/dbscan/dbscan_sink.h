@@ -0,0 +1,121 @@
+/*
+ * dbscan_sink.h
+ *
+ *  Created on: 2024-9-14
+ *      Author: xdu
+ */
+
+#ifndef DBSCAN_SINK_H_
+#define DBSCAN_SINK_H_
+
+#include "dbscan.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * 聚类结果的写出接口，每帧dbscan()之后调用dbscan_sink_write().
+ * 具体的写出方式嵌入struct dbscan_sink作为第一个成员:
+ *     dbscan_bin_sink   紧凑的二进制记录(类编号和/或各类的统计);
+ *     dbscan_text_sink  与print_dbscan_result()相同的文本格式;
+ *     dbscan_async_sink 在另一个线程中写出(见dbscan_async.h).
+ * bin/text在自己申请的大缓冲区中格式化，满了才fwrite，不使用stdio的缓冲;
+ * 也可以由调用者提供较小的缓冲区(*_init_buf)，这时保留stdio的缓冲，不从堆上申请.
+ */
+#define DBSCAN_SINK_NEED_PDW (1u << 0)	/* 写出时需要各点的PDW，而不只是类编号 */
+
+struct dbscan_sink {
+	/* 写出一帧，seq为帧号，成功返回0 */
+	int (*write)(struct dbscan_sink *sink, const dbscan_st *db, unsigned int seq);
+	/* 把已写出的帧交给文件 */
+	int (*flush)(struct dbscan_sink *sink);
+	/* flush后释放，之后不能再使用 */
+	int (*close)(struct dbscan_sink *sink);
+	unsigned int flags;			/* DBSCAN_SINK_NEED_PDW等 */
+};
+
+static inline int dbscan_sink_write(struct dbscan_sink *sink, const dbscan_st *db,
+		unsigned int seq)
+{
+	return sink->write(sink, db, seq);
+}
+
+static inline int dbscan_sink_flush(struct dbscan_sink *sink)
+{
+	return sink->flush(sink);
+}
+
+static inline int dbscan_sink_close(struct dbscan_sink *sink)
+{
+	return sink->close(sink);
+}
+
+/* bin/text共用的输出缓冲区 */
+struct dbscan_sink_buf {
+	FILE *fp;
+	char *buf;
+	size_t len;
+	size_t cap;
+	int err;					/* 写文件出错后为1 */
+	int own;					/* buf由sink申请，close时释放 */
+};
+
+#define DBSCAN_SINK_BUFSIZE (1 << 20)
+#define DBSCAN_SINK_MIN_BUFSIZE (4 * 1024)	/* 不小于一块类编号或一行文本 */
+
+/*
+ * 二进制记录，按本机字节序，每帧:
+ *     struct dbscan_rec;
+ *     summary为1时，ngroup个struct dbscan_rec_cluster，依次对应类1~ngroup;
+ *     label_bytes不为0时，npdw个类编号(1~ngroup，噪声为0)，每个占label_bytes字节，补齐到4字节.
+ * ngroup为该帧类编号的最大值: dbscan()的编号连续，即类数;
+ * dbscan_stream等的编号可能不连续，未使用的编号对应的struct dbscan_rec_cluster全为0.
+ * label_bytes按ngroup取能容纳的最小值(1、2或4).
+ */
+#define DBSCAN_REC_MAGIC (0x52534244u)	/* "DBSR" */
+
+#define DBSCAN_BIN_LABELS  (1u << 0)	/* 写出各点的类编号 */
+#define DBSCAN_BIN_SUMMARY (1u << 1)	/* 写出各类的点数和均值 */
+
+struct dbscan_rec {
+	unsigned int magic;
+	unsigned int seq;
+	unsigned int npdw;
+	unsigned int ngroup;		/* 类编号的最大值 */
+	unsigned int nnoise;
+	unsigned char label_bytes;
+	unsigned char summary;
+	unsigned short reserved;
+};
+
+/* 各维为类中各点的算术平均，aoa不处理回绕 */
+struct dbscan_rec_cluster {
+	unsigned int count;
+	unsigned int aoa;
+	unsigned int freq;
+	unsigned int pw;
+};
+
+struct dbscan_bin_sink {
+	struct dbscan_sink base;
+	struct dbscan_sink_buf out;
+	unsigned int what;			/* DBSCAN_BIN_LABELS | DBSCAN_BIN_SUMMARY */
+	unsigned long long *sum;	/* 统计各类时的累加值，每类4个 */
+	unsigned int nsum;			/* sum能容纳的类数 */
+};
+
+/* what为DBSCAN_BIN_*的组合，bufsize为0时取DBSCAN_SINK_BUFSIZE */
+int dbscan_bin_sink_init(struct dbscan_bin_sink *s, const char *path, unsigned int what,
+		size_t bufsize);
+
+struct dbscan_text_sink {
+	struct dbscan_sink base;
+	struct dbscan_sink_buf out;
+};
+
+int dbscan_text_sink_init(struct dbscan_text_sink *s, const char *path, size_t bufsize);
+
+/* 使用调用者的缓冲区buf，size不小于DBSCAN_SINK_MIN_BUFSIZE，close之前buf须一直有效 */
+int dbscan_text_sink_init_buf(struct dbscan_text_sink *s, const char *path, char *buf,
+		size_t size);
+
+#endif /* DBSCAN_SINK_H_ */
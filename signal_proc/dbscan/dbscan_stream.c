@@ -0,0 +1,527 @@
+/*
+ * dbscan_stream.c
+ *
+ *  Created on: 2024-8-19
+ *      Author: xdu
+ */
+
+#include "dbscan_stream.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IS_CORE(s, p) ((s)->db.visited[p] == CENTER)
+
+static inline unsigned int hash_cell(dbscan_stream_st *s, unsigned int x, unsigned int y)
+{
+	return ((x * 0x9E3779B1u) ^ (y * 0x85EBCA77u)) & (s->nbucket - 1);
+}
+
+/* 网格边长取e领域在aoa、pw上的半径 */
+static inline unsigned int width_aoa(dbscan_stream_st *s)
+{
+	return METRIC_R_AOA(s->e) ? METRIC_R_AOA(s->e) : 1;
+}
+
+static inline unsigned int width_pw(dbscan_stream_st *s)
+{
+	return METRIC_R_PW(s->e) ? METRIC_R_PW(s->e) : 1;
+}
+
+static void link_point(dbscan_stream_st *s, int p)
+{
+	unsigned int b;
+
+	s->cx[p] = PDW_AOA(&s->db, p) / width_aoa(s);
+	s->cy[p] = PDW_PW(&s->db, p) / width_pw(s);
+	b = hash_cell(s, s->cx[p], s->cy[p]);
+
+	s->prev[p] = -1;
+	s->next[p] = s->bucket[b];
+	if (s->bucket[b] >= 0)
+		s->prev[s->bucket[b]] = p;
+	s->bucket[b] = p;
+}
+
+static void unlink_point(dbscan_stream_st *s, int p)
+{
+	if (s->prev[p] >= 0)
+		s->next[s->prev[p]] = s->next[p];
+	else
+		s->bucket[hash_cell(s, s->cx[p], s->cy[p])] = s->next[p];
+
+	if (s->next[p] >= 0)
+		s->prev[s->next[p]] = s->prev[p];
+}
+
+/*
+ * p的e领域(含自身)，只访问aoa窗口覆盖的列(不回绕时为相邻的3列)中相邻的3行，
+ * 不同网格可能散列到同一个桶，按网格编号过滤.
+ */
+static int search(dbscan_stream_st *s, int p, int *nbrs)
+{
+	unsigned int lo[2], hi[2];
+	unsigned int x, xhi, y, ylo, yhi;
+	int q, r, nr;
+	int nnbr = 0;
+
+	ylo = s->cy[p] ? s->cy[p] - 1 : 0;
+	yhi = s->cy[p] < UINT_MAX ? s->cy[p] + 1 : UINT_MAX;
+
+	nr = metric_aoa_ranges(PDW_AOA(&s->db, p), METRIC_R_AOA(s->e), lo, hi);
+	for (r = 0; r < nr; ++r) {
+		xhi = hi[r] / width_aoa(s);
+
+		for (x = lo[r] / width_aoa(s); x <= xhi; ++x) {
+			for (y = ylo; ; ++y) {
+				for (q = s->bucket[hash_cell(s, x, y)]; q >= 0; q = s->next[q]) {
+					if (s->cx[q] != x || s->cy[q] != y)
+						continue;
+
+					if (!pdw_within(&s->db, p, q, s->e))
+						continue;
+
+					nbrs[nnbr] = q;
+					++nnbr;
+				}
+
+				/* 行号已到上限，cy为UINT_MAX时不回绕 */
+				if (y == yhi)
+					break;
+			}
+
+			/* 列号已到上限 */
+			if (x == xhi)
+				break;
+		}
+	}
+
+	return nnbr;
+}
+
+static int alloc_id(dbscan_stream_st *s)
+{
+	int id = s->free_id[--s->nfree];
+
+	s->ncore[id] = 0;
+	++s->db.ngroup;
+
+	return id;
+}
+
+/* 类id的核心点数加k，为0时回收编号 */
+static void add_core(dbscan_stream_st *s, int id, int k)
+{
+	s->ncore[id] += k;
+
+	if (s->ncore[id] == 0) {
+		s->free_id[s->nfree++] = id;
+		--s->db.ngroup;
+	}
+}
+
+/*
+ * 从核心点p出发，把与p连通的编号为from的核心点，以及它们e领域内编号为from的
+ * 非核心点改为to，返回改动的核心点数.
+ */
+static int relabel(dbscan_stream_st *s, int p, int from, int to)
+{
+	dbscan_st *db = &s->db;
+	int *nbrs = s->nbr[2];
+	int head = 0, tail = 0;
+	int k, q, nnbr;
+
+	db->major[p] = to;
+	s->queue[tail++] = p;
+
+	while (head < tail) {
+		p = s->queue[head++];
+		s->visit[p] = s->vepoch;
+
+		nnbr = search(s, p, nbrs);
+		for (k = 0; k < nnbr; ++k) {
+			q = nbrs[k];
+
+			if (db->major[q] != from)
+				continue;
+
+			db->major[q] = to;
+			if (IS_CORE(s, q))
+				s->queue[tail++] = q;
+		}
+	}
+
+	return tail;
+}
+
+/* 合并核心点pa所在的类与核心点pb所在的类，核心点少的并入多的，返回合并后的编号 */
+static int merge(dbscan_stream_st *s, int pa, int pb)
+{
+	int a = s->db.major[pa];
+	int b = s->db.major[pb];
+	int t;
+
+	if (s->ncore[a] < s->ncore[b]) {
+		t = pa;
+		pa = pb;
+		pb = t;
+
+		t = a;
+		a = b;
+		b = t;
+	}
+
+	relabel(s, pb, b, a);
+	s->ncore[a] += s->ncore[b];
+	add_core(s, b, -s->ncore[b]);
+
+	return a;
+}
+
+/* c刚成为核心点，与e领域内的核心点合为一类，e领域内的噪声点成为边界点 */
+static void promote(dbscan_stream_st *s, int c)
+{
+	dbscan_st *db = &s->db;
+	int *nbrs = s->nbr[1];
+	int k, q, nnbr, id = -1;
+
+	nnbr = search(s, c, nbrs);
+
+	for (k = 0; k < nnbr; ++k) {
+		q = nbrs[k];
+
+		if (q != c && IS_CORE(s, q) && db->major[q] > 0) {
+			id = db->major[q];
+			break;
+		}
+	}
+
+	if (id < 0)
+		id = alloc_id(s);
+
+	db->major[c] = id;
+	add_core(s, id, 1);
+
+	for (k = 0; k < nnbr; ++k) {
+		q = nbrs[k];
+
+		if (q == c)
+			continue;
+
+		if (IS_CORE(s, q)) {
+			/* 编号为-1的是本次新增、尚未处理的核心点 */
+			if (db->major[q] > 0 && db->major[q] != db->major[c])
+				merge(s, c, q);
+		} else if (db->major[q] < 0) {
+			db->major[q] = db->major[c];
+			db->visited[q] = EDGE;
+		}
+	}
+}
+
+static void insert_point(dbscan_stream_st *s, int p)
+{
+	dbscan_st *db = &s->db;
+	int *nbrs = s->nbr[0];
+	int k, q, nnbr;
+
+	db->visited[p] = NOISE;
+	db->major[p] = -1;
+	link_point(s, p);
+
+	nnbr = search(s, p, nbrs);
+	s->count[p] = nnbr;
+
+	/* 先标记全部新增的核心点，再逐个处理 */
+	for (k = 0; k < nnbr; ++k) {
+		q = nbrs[k];
+
+		if (q != p && ++s->count[q] == s->minpts) {
+			db->visited[q] = CENTER;
+			db->major[q] = -1;
+		}
+	}
+
+	if (s->count[p] >= s->minpts)
+		db->visited[p] = CENTER;
+
+	for (k = 0; k < nnbr; ++k) {
+		q = nbrs[k];
+
+		if (IS_CORE(s, q) && db->major[q] < 0)
+			promote(s, q);
+	}
+
+	if (db->major[p] >= 0)
+		return;
+
+	/* p不是核心点，归入任一相邻的类 */
+	for (k = 0; k < nnbr; ++k) {
+		q = nbrs[k];
+
+		if (IS_CORE(s, q)) {
+			db->major[p] = db->major[q];
+			db->visited[p] = EDGE;
+			break;
+		}
+	}
+}
+
+/* 记录list中的核心点和非核心点，每个点只记录一次 */
+static void gather(dbscan_stream_st *s, const int *list, int n, int *nseed, int *nborder)
+{
+	int k, q;
+
+	for (k = 0; k < n; ++k) {
+		q = list[k];
+
+		if (s->db.visited[q] == UNLABELED || s->mark[q] == s->epoch)
+			continue;
+
+		s->mark[q] = s->epoch;
+
+		if (IS_CORE(s, q))
+			s->seeds[(*nseed)++] = q;
+		else
+			s->borders[(*nborder)++] = q;
+	}
+}
+
+/* 在核心点中从p开始BFS，遇到need个种子后提前结束，返回1表示提前结束 */
+static int reach(dbscan_stream_st *s, int p, int need)
+{
+	int *nbrs = s->nbr[2];
+	int head = 0, tail = 0;
+	int k, q, nnbr;
+
+	s->visit[p] = s->vepoch;
+	s->queue[tail++] = p;
+	if (--need == 0)
+		return 1;
+
+	while (head < tail) {
+		p = s->queue[head++];
+
+		nnbr = search(s, p, nbrs);
+		for (k = 0; k < nnbr; ++k) {
+			q = nbrs[k];
+
+			if (!IS_CORE(s, q) || s->visit[q] == s->vepoch)
+				continue;
+
+			s->visit[q] = s->vepoch;
+			s->queue[tail++] = q;
+
+			if (s->mark[q] == s->epoch && --need == 0)
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void remove_point(dbscan_stream_st *s, int x)
+{
+	dbscan_st *db = &s->db;
+	int *nbrs = s->nbr[0];
+	int was_core = IS_CORE(s, x);
+	int nseed = 0, nborder = 0, ndemoted = 0;
+	int i, k, q, id, old, nnbr, need;
+
+	nnbr = search(s, x, nbrs);
+	for (k = 0; k < nnbr; ++k) {
+		q = nbrs[k];
+
+		if (q == x)
+			continue;
+
+		--s->count[q];
+		if (IS_CORE(s, q) && s->count[q] < s->minpts) {
+			/* 暂记为边界点，稍后重新归类 */
+			db->visited[q] = EDGE;
+			add_core(s, db->major[q], -1);
+			s->demoted[ndemoted++] = q;
+		}
+	}
+
+	if (was_core)
+		add_core(s, db->major[x], -1);
+
+	unlink_point(s, x);
+	db->visited[x] = UNLABELED;
+	db->major[x] = -1;
+	s->count[x] = 0;
+
+	/* 移出的是非核心点，且没有点失去核心状态，不影响其他点 */
+	if (!was_core && ndemoted == 0)
+		return;
+
+	/* 与x及失去核心状态的点相邻的核心点可能不再连通，相邻的非核心点需要重新归类 */
+	++s->epoch;
+	gather(s, nbrs, nnbr, &nseed, &nborder);
+	for (i = 0; i < ndemoted; ++i) {
+		nnbr = search(s, s->demoted[i], s->nbr[1]);
+		gather(s, s->nbr[1], nnbr, &nseed, &nborder);
+	}
+
+	/* 编号相同的种子第一次BFS时保留原编号，之后未访问到的种子各自成为新的类 */
+	++s->vepoch;
+	for (i = 0; i < nseed; ++i) {
+		q = s->seeds[i];
+
+		if (s->visit[q] == s->vepoch)
+			continue;
+
+		if (s->kept[db->major[q]] == s->vepoch) {
+			old = db->major[q];
+			id = alloc_id(s);
+			k = relabel(s, q, old, id);
+			add_core(s, id, k);
+			add_core(s, old, -k);
+			continue;
+		}
+
+		need = 0;
+		for (k = i; k < nseed; ++k) {
+			if (db->major[s->seeds[k]] == db->major[q]
+					&& s->visit[s->seeds[k]] != s->vepoch)
+				++need;
+		}
+
+		reach(s, q, need);
+		s->kept[db->major[q]] = s->vepoch;
+	}
+
+	for (i = 0; i < nborder; ++i) {
+		q = s->borders[i];
+
+		db->major[q] = -1;
+		db->visited[q] = NOISE;
+
+		nnbr = search(s, q, s->nbr[1]);
+		for (k = 0; k < nnbr; ++k) {
+			if (IS_CORE(s, s->nbr[1][k])) {
+				db->major[q] = db->major[s->nbr[1][k]];
+				db->visited[q] = EDGE;
+				break;
+			}
+		}
+	}
+}
+
+int init_dbscan_stream(dbscan_stream_st *s, unsigned int window,
+		unsigned int e, unsigned int minpts)
+{
+	int *p;
+	unsigned int i;
+
+	if (window == 0 || init_dbscan(&s->db, window) < 0)
+		return -1;
+
+	s->e = e;
+	s->minpts = minpts;
+	s->window = window;
+	s->head = 0;
+	s->npts = 0;
+
+	for (s->nbucket = 1; s->nbucket < 2 * window; s->nbucket <<= 1)
+		;
+
+	s->block = malloc(sizeof(int) * (17 * (size_t)window + s->nbucket + 2));
+	if (!s->block) {
+		printf("init_dbscan_stream: malloc failed.\n");
+		del_dbscan(&s->db);
+		return -1;
+	}
+
+	p = (int *)s->block;
+	s->count = p;					p += window;
+	s->cx = (unsigned int *)p;		p += window;
+	s->cy = (unsigned int *)p;		p += window;
+	s->next = p;					p += window;
+	s->prev = p;					p += window;
+	s->mark = (unsigned int *)p;	p += window;
+	s->visit = (unsigned int *)p;	p += window;
+	s->nbr[0] = p;					p += window;
+	s->nbr[1] = p;					p += window;
+	s->nbr[2] = p;					p += window;
+	s->queue = p;					p += window;
+	s->seeds = p;					p += window;
+	s->borders = p;					p += window;
+	s->demoted = p;					p += window;
+	s->free_id = p;					p += window;
+	s->ncore = p;					p += window + 1;
+	s->kept = (unsigned int *)p;	p += window + 1;
+	s->bucket = p;
+
+	memset(s->block, 0, sizeof(int) * (17 * (size_t)window + 2));
+	memset(s->bucket, -1, sizeof(int) * s->nbucket);
+	s->epoch = 0;
+	s->vepoch = 0;
+
+	/* 类编号1..window，先分配小的 */
+	for (i = 0; i < window; ++i)
+		s->free_id[i] = window - i;
+	s->nfree = window;
+
+	s->db.capacity = window;
+	s->db.ngroup = 0;
+	for (i = 0; i < window; ++i) {
+		s->db.major[i] = -1;
+		s->db.visited[i] = UNLABELED;
+	}
+
+	return 0;
+}
+
+int dbscan_stream_push(dbscan_stream_st *s, const ORIG_PDW *src)
+{
+	int p;
+
+	if (s->npts >= s->window)
+		return -1;
+
+	p = (s->head + s->npts) % s->window;
+	++s->npts;
+
+	PDW_AOA(&s->db, p) = src->AOA;
+	PDW_FREQ(&s->db, p) = src->FC;
+	PDW_PW(&s->db, p) = src->PW;
+
+	insert_point(s, p);
+
+	return p;
+}
+
+int dbscan_stream_expire(dbscan_stream_st *s)
+{
+	int x;
+
+	if (s->npts == 0)
+		return -1;
+
+	x = s->head;
+	remove_point(s, x);
+
+	s->head = (s->head + 1) % s->window;
+	--s->npts;
+
+	return x;
+}
+
+int dbscan_stream_slide(dbscan_stream_st *s, const ORIG_PDW *src)
+{
+	if (s->npts >= s->window)
+		dbscan_stream_expire(s);
+
+	return dbscan_stream_push(s, src);
+}
+
+void del_dbscan_stream(dbscan_stream_st *s)
+{
+	free(s->block);
+	s->block = NULL;
+
+	del_dbscan(&s->db);
+}
@@ -0,0 +1,77 @@
+/*
+ * dbscan_stream.h
+ *
+ *  Created on: 2024-8-19
+ *      Author: xdu
+ */
+
+#ifndef DBSCAN_STREAM_H_
+#define DBSCAN_STREAM_H_
+
+#include "dbscan.h"
+
+/*
+ * 滑动窗口增量dbscan.
+ * 窗口中的点存放在db中，按进入的先后占用槽0..window-1(循环使用)，
+ * db.major为所在类的编号(噪声为-1)，db.visited为CENTER/EDGE/NOISE，空槽为UNLABELED.
+ * 每次加入或移出一个点，只更新其e领域内点的核心状态，
+ * 类的合并、分裂只在受影响的类中进行，不对整个窗口重新聚类.
+ * 核心点的划分与对窗口中的点调用dbscan()相同，边界点归入任一相邻的类，类编号不同.
+ */
+typedef struct dbscan_stream {
+	dbscan_st db;
+	unsigned int e;
+	unsigned int minpts;
+	unsigned int window;		/* 窗口容量 */
+	unsigned int head;			/* 最早进入窗口的点所在的槽 */
+	unsigned int npts;			/* 窗口中的点数 */
+
+	int *count;					/* e领域内的点数(含自身) */
+
+	/* (aoa, pw)网格，网格边长为e，按网格编号散列到nbucket个桶中 */
+	unsigned int *cx;
+	unsigned int *cy;
+	int *next;					/* 同一个桶中的下一个点 */
+	int *prev;
+	int *bucket;
+	unsigned int nbucket;
+
+	unsigned int *mark;			/* 去重标记，等于epoch表示已记录 */
+	unsigned int epoch;
+	unsigned int *visit;		/* 分裂检查的访问标记 */
+	unsigned int vepoch;
+
+	int *nbr[3];				/* 嵌套的e领域搜索各用一个 */
+	int *queue;
+	int *seeds;					/* 移出点后需检查连通性的核心点 */
+	int *borders;				/* 移出点后需重新归类的非核心点 */
+	int *demoted;				/* 失去核心状态的点 */
+
+	int *ncore;					/* 各类的核心点数，类编号为1..window */
+	int *free_id;				/* 未使用的类编号 */
+	int nfree;
+	unsigned int *kept;			/* 分裂检查中已保留原编号的类 */
+
+	void *block;
+}dbscan_stream_st;
+
+int init_dbscan_stream(dbscan_stream_st *s, unsigned int window,
+		unsigned int e, unsigned int minpts);
+
+/* 加入一个点，返回其所在的槽，窗口已满时返回-1 */
+int dbscan_stream_push(dbscan_stream_st *s, const ORIG_PDW *src);
+
+/* 移出最早的点，返回其所在的槽，窗口为空时返回-1 */
+int dbscan_stream_expire(dbscan_stream_st *s);
+
+/* 窗口已满时先移出最早的点，再加入新点 */
+int dbscan_stream_slide(dbscan_stream_st *s, const ORIG_PDW *src);
+
+static inline int dbscan_stream_label(dbscan_stream_st *s, int slot)
+{
+	return s->db.major[slot];
+}
+
+void del_dbscan_stream(dbscan_stream_st *s);
+
+#endif /* DBSCAN_STREAM_H_ */
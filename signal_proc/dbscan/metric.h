@@ -0,0 +1,137 @@
+/*
+ * metric.h
+ *
+ *  Created on: 2024-9-2
+ *      Author: xdu
+ */
+
+#ifndef METRIC_H_
+#define METRIC_H_
+
+/*
+ * 两个PDW之间的距离，编译时选定，在e领域搜索的循环中内联展开.
+ * 各维先取差值的绝对值再乘以权重，记为da/df/dp，然后按METRIC_MEASURE合成:
+ *     METRIC_L1   da + df + dp;
+ *     METRIC_LINF max(da, df, dp);
+ *     METRIC_L2SQ da^2 + df^2 + dp^2，与e^2比较，按64位计算.
+ * 加权后各维的差值需小于2^31，L1的和需小于2^32.
+ */
+#define METRIC_L1   1
+#define METRIC_LINF 2
+#define METRIC_L2SQ 3
+
+#ifndef METRIC_MEASURE
+#define METRIC_MEASURE METRIC_L1
+#endif
+
+/* 为1时计入freq，否则只比较aoa与pw */
+#ifndef METRIC_FREQ
+#define METRIC_FREQ 0
+#endif
+
+/* 各维的权重，为正整数 */
+#ifndef METRIC_W_AOA
+#define METRIC_W_AOA 1
+#endif
+#ifndef METRIC_W_FREQ
+#define METRIC_W_FREQ 1
+#endif
+#ifndef METRIC_W_PW
+#define METRIC_W_PW 1
+#endif
+
+/*
+ * aoa的周期(同为12.20定点数，如360 << 20)，为0时不回绕.
+ * 回绕时aoa需在[0, METRIC_AOA_PERIOD)内，差值取|Δaoa|与周期减|Δaoa|中较小的.
+ */
+#ifndef METRIC_AOA_PERIOD
+#define METRIC_AOA_PERIOD 0
+#endif
+
+/* e领域在各维上的半径: 三种合成方式下，任一维加权后的差值都不超过e */
+#define METRIC_R_AOA(e)  ((e) / METRIC_W_AOA)
+#define METRIC_R_FREQ(e) ((e) / METRIC_W_FREQ)
+#define METRIC_R_PW(e)   ((e) / METRIC_W_PW)
+
+static inline unsigned int metric_absdiff(unsigned int a, unsigned int b)
+{
+	return a > b ? a - b : b - a;
+}
+
+static inline unsigned int metric_aoa_diff(unsigned int a, unsigned int b)
+{
+	unsigned int d = metric_absdiff(a, b);
+
+#if METRIC_AOA_PERIOD
+	if (d > METRIC_AOA_PERIOD - d)
+		d = METRIC_AOA_PERIOD - d;
+#endif
+
+	return d;
+}
+
+/* (a1, f1, p1)与(a2, f2, p2)的距离是否不大于e */
+static inline int metric_within(unsigned int a1, unsigned int f1, unsigned int p1,
+		unsigned int a2, unsigned int f2, unsigned int p2, unsigned int e)
+{
+	unsigned int da = METRIC_W_AOA * metric_aoa_diff(a1, a2);
+	unsigned int dp = METRIC_W_PW * metric_absdiff(p1, p2);
+#if METRIC_FREQ
+	unsigned int df = METRIC_W_FREQ * metric_absdiff(f1, f2);
+#else
+	unsigned int df = 0;
+
+	(void)f1;
+	(void)f2;
+#endif
+
+#if METRIC_MEASURE == METRIC_L1
+	return da + df + dp <= e;
+#elif METRIC_MEASURE == METRIC_LINF
+	return (da <= e) & (df <= e) & (dp <= e);
+#elif METRIC_MEASURE == METRIC_L2SQ
+	return (unsigned long long)da * da + (unsigned long long)df * df
+			+ (unsigned long long)dp * dp <= (unsigned long long)e * e;
+#else
+#error "unknown METRIC_MEASURE"
+#endif
+}
+
+/*
+ * 与a的aoa差值不超过r的原始aoa区间[lo[k], hi[k]]，返回区间数.
+ * 不回绕时为1段; 回绕时跨过0或周期的窗口分为2段.
+ * r不小于周期的1/3时取整个周期，这样按边长r划分的网格中，两段覆盖的列不会重叠.
+ */
+static inline int metric_aoa_ranges(unsigned int a, unsigned int r,
+		unsigned int lo[2], unsigned int hi[2])
+{
+#if METRIC_AOA_PERIOD
+	if (r >= METRIC_AOA_PERIOD / 3) {
+		lo[0] = 0;
+		hi[0] = METRIC_AOA_PERIOD - 1;
+		return 1;
+	}
+
+	if (a < r) {
+		lo[0] = 0;
+		hi[0] = a + r;
+		lo[1] = a + METRIC_AOA_PERIOD - r;
+		hi[1] = METRIC_AOA_PERIOD - 1;
+		return 2;
+	}
+
+	if (a + r >= METRIC_AOA_PERIOD) {
+		lo[0] = a - r;
+		hi[0] = METRIC_AOA_PERIOD - 1;
+		lo[1] = 0;
+		hi[1] = a + r - METRIC_AOA_PERIOD;
+		return 2;
+	}
+#endif
+
+	lo[0] = a > r ? a - r : 0;
+	hi[0] = a + r < a ? ~0u : a + r;
+	return 1;
+}
+
+#endif /* METRIC_H_ */
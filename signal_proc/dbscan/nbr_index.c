@@ -0,0 +1,377 @@
+/*
+ * nbr_index.c
+ *
+ *  Created on: 2024-7-15
+ *      Author: xdu
+ */
+
+#include "dbscan.h"
+#include "nbr_kernel.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 各种search()把距离计算次数加到*ndist，DBSCAN_PROF为0时不计数 */
+#if DBSCAN_PROF
+#define NDIST_ADD(ndist, n) (*(ndist) += (n))
+#else
+#define NDIST_ADD(ndist, n) ((void)0)
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_GRID
+
+/* 堆排序，key与perm同步交换 */
+static void sift_down(unsigned long long *key, pt_index_t *perm, int root, int n)
+{
+	int child;
+	unsigned long long k = key[root];
+	int p = perm[root];
+
+	while ((child = 2 * root + 1) < n) {
+		if (child + 1 < n && key[child + 1] > key[child])
+			++child;
+
+		if (key[child] <= k)
+			break;
+
+		key[root] = key[child];
+		perm[root] = perm[child];
+		root = child;
+	}
+
+	key[root] = k;
+	perm[root] = p;
+}
+
+static void sort_by_key(unsigned long long *key, pt_index_t *perm, int n)
+{
+	int i;
+	unsigned long long k;
+	int p;
+
+	for (i = n / 2 - 1; i >= 0; --i)
+		sift_down(key, perm, i, n);
+
+	for (i = n - 1; i > 0; --i) {
+		k = key[0];
+		key[0] = key[i];
+		key[i] = k;
+
+		p = perm[0];
+		perm[0] = perm[i];
+		perm[i] = p;
+
+		sift_down(key, perm, 0, i);
+	}
+}
+
+static inline unsigned long long cell_key(unsigned int cx, unsigned int cy)
+{
+	return ((unsigned long long)cx << 32) | cy;
+}
+
+/*
+ * 网格边长取e领域在aoa、pw上的半径，e领域内的点只可能落在
+ * 查询点aoa窗口覆盖的列中(不回绕时为相邻的3列)、行号相差不超过1的网格中.
+ */
+int nbr_index_build(struct dbscan *db, unsigned int e)
+{
+	struct nbr_index *idx = &db->index;
+	int n = db->capacity;
+	int i, c;
+	unsigned int cx, cy;
+
+	idx->e = e;
+	idx->width_aoa = METRIC_R_AOA(e) ? METRIC_R_AOA(e) : 1;
+	idx->width_pw = METRIC_R_PW(e) ? METRIC_R_PW(e) : 1;
+	idx->ncell = 0;
+
+	if (n <= 0)
+		return 0;
+
+	idx->aoa_min = PDW_AOA(db, 0);
+	idx->pw_min = PDW_PW(db, 0);
+	for (i = 1; i < n; ++i) {
+		if (PDW_AOA(db, i) < idx->aoa_min)
+			idx->aoa_min = PDW_AOA(db, i);
+		if (PDW_PW(db, i) < idx->pw_min)
+			idx->pw_min = PDW_PW(db, i);
+	}
+
+	for (i = 0; i < n; ++i) {
+		cx = (PDW_AOA(db, i) - idx->aoa_min) / idx->width_aoa;
+		cy = (PDW_PW(db, i) - idx->pw_min) / idx->width_pw;
+		idx->key[i] = cell_key(cx, cy);
+		idx->perm[i] = i;
+	}
+
+	sort_by_key(idx->key, idx->perm, n);
+
+	/* 相同编号的点在perm中连续，把key压缩为非空网格表 */
+	c = 0;
+	idx->start[0] = 0;
+	for (i = 1; i < n; ++i) {
+		if (idx->key[i] == idx->key[c])
+			continue;
+
+		++c;
+		idx->key[c] = idx->key[i];
+		idx->start[c] = i;
+	}
+
+	idx->ncell = c + 1;
+	idx->start[idx->ncell] = n;
+
+	return idx->ncell;
+}
+
+/* 返回第一个编号不小于k的网格 */
+static int lower_bound(const struct nbr_index *idx, unsigned long long k)
+{
+	int lo = 0, hi = idx->ncell, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (idx->key[mid] < k)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static inline int search(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs,
+		unsigned long long *ndist)
+{
+	struct nbr_index *idx = &db->index;
+	unsigned int lo[2], hi[2];
+	unsigned int cy, x, xhi, ylo, yhi;
+	int c, k, j, r, nr;
+	int nnbr = 0;
+
+	cy = (PDW_PW(db, point) - idx->pw_min) / idx->width_pw;
+	ylo = cy ? cy - 1 : 0;
+	yhi = cy < UINT_MAX ? cy + 1 : UINT_MAX;
+
+	nr = metric_aoa_ranges(PDW_AOA(db, point), METRIC_R_AOA(e), lo, hi);
+	for (r = 0; r < nr; ++r) {
+		if (hi[r] < idx->aoa_min)
+			continue;
+
+		x = lo[r] > idx->aoa_min ? (lo[r] - idx->aoa_min) / idx->width_aoa : 0;
+		xhi = (hi[r] - idx->aoa_min) / idx->width_aoa;
+
+		/* 同一列中行号相邻的3个网格在key中连续 */
+		for (; x <= xhi; ++x) {
+			for (c = lower_bound(idx, cell_key(x, ylo));
+					c < idx->ncell && idx->key[c] <= cell_key(x, yhi); ++c) {
+				NDIST_ADD(ndist, idx->start[c + 1] - idx->start[c]);
+				for (k = idx->start[c]; k < idx->start[c + 1]; ++k) {
+					j = idx->perm[k];
+
+					if (!pdw_within(db, point, j, e))
+						continue;
+
+					nbrs[nnbr] = j;
+					++nnbr;
+				}
+			}
+
+			/* 已过最后一个非空网格 */
+			if (c == idx->ncell)
+				break;
+		}
+	}
+
+	return nnbr;
+}
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_BRUTE_FORCE
+int nbr_index_build(struct dbscan *db, unsigned int e)
+{
+	db->index.e = e;
+
+	return 0;
+}
+
+static inline int search(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs,
+		unsigned long long *ndist)
+{
+	NDIST_ADD(ndist, db->capacity);
+
+#if PDW_LAYOUT == PDW_SOA
+	/* aoa与pw连续存放，一次比较多个点 */
+	return nbr_kernel(db->aoa, db->freq, db->pw, db->capacity,
+			db->aoa[point], db->freq[point], db->pw[point], e, nbrs);
+#else
+	int j = 0;
+	int nnbr = 0;
+	int length = db->capacity;
+
+	for (j = 0; j < length; ++j) {
+		if (!pdw_within(db, point, j, e))
+			continue;
+
+		nbrs[nnbr] = j;
+		++nnbr;
+	}
+
+	return nnbr;
+#endif
+}
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_SORTED_SWEEP
+
+#define AOA_OF(db, k) PDW_AOA(db, (db)->index.perm[k])
+
+/* 堆排序，只移动序号，按aoa比较 */
+static void sift_down(dbscan_st *db, int root, int n)
+{
+	pt_index_t *perm = db->index.perm;
+	int child;
+	int p = perm[root];
+	unsigned int k = PDW_AOA(db, p);
+
+	while ((child = 2 * root + 1) < n) {
+		if (child + 1 < n && AOA_OF(db, child + 1) > AOA_OF(db, child))
+			++child;
+
+		if (AOA_OF(db, child) <= k)
+			break;
+
+		perm[root] = perm[child];
+		root = child;
+	}
+
+	perm[root] = p;
+}
+
+int nbr_index_build(struct dbscan *db, unsigned int e)
+{
+	pt_index_t *perm = db->index.perm;
+	int n = db->capacity;
+	int i, p;
+
+	db->index.e = e;
+
+	for (i = 0; i < n; ++i)
+		perm[i] = i;
+
+	for (i = n / 2 - 1; i >= 0; --i)
+		sift_down(db, i, n);
+
+	for (i = n - 1; i > 0; --i) {
+		p = perm[0];
+		perm[0] = perm[i];
+		perm[i] = p;
+
+		sift_down(db, 0, i);
+	}
+
+	return n;
+}
+
+/* 返回perm中第一个aoa不小于a的位置 */
+static int lower_bound(dbscan_st *db, unsigned int a)
+{
+	int lo = 0, hi = db->capacity, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+
+		if (AOA_OF(db, mid) < a)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static inline int search(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs,
+		unsigned long long *ndist)
+{
+	int length = db->capacity;
+	unsigned int lo[2], hi[2];
+	int k, j, r, nr;
+	int nnbr = 0;
+
+	/* e领域内的点的aoa一定在这1~2段窗口中 */
+	nr = metric_aoa_ranges(PDW_AOA(db, point), METRIC_R_AOA(e), lo, hi);
+	for (r = 0; r < nr; ++r) {
+		for (k = lower_bound(db, lo[r]); k < length && AOA_OF(db, k) <= hi[r]; ++k) {
+			j = db->index.perm[k];
+			NDIST_ADD(ndist, 1);
+
+			if (!pdw_within(db, point, j, e))
+				continue;
+
+			/* perm中存放的是原始序号，结果直接对应db->major */
+			nbrs[nnbr] = j;
+			++nnbr;
+		}
+	}
+
+	return nnbr;
+}
+#endif
+
+int nbr_index_search(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs)
+{
+#if DBSCAN_PROF
+	return search(db, point, e, nbrs, &db->prof.ndist);
+#else
+	return search(db, point, e, nbrs, NULL);
+#endif
+}
+
+#if DBSCAN_PROF
+int nbr_index_search_count(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs,
+		unsigned long long *ndist)
+{
+	return search(db, point, e, nbrs, ndist);
+}
+#endif
+
+#if NBR_GRAPH
+/*
+ * 依次搜索每个点并存入edge，返回已存下的点数.
+ * 剩余容量不少于capacity时直接写入edge，否则先写入new_nbrs，放得下再拷贝.
+ */
+int nbr_graph_build(struct dbscan *db, unsigned int e)
+{
+	struct nbr_graph *gr = &db->graph;
+	unsigned int n = db->capacity;
+	unsigned int nedge = 0;
+	int i, nnbr;
+
+	gr->e = e;
+	gr->valid = 1;
+	gr->built = 0;
+
+	for (i = 0; i < n; ++i) {
+		gr->offset[i] = nedge;
+
+		if (gr->cap - nedge >= n) {
+			nnbr = nbr_index_search(db, i, e, gr->edge + nedge);
+		} else {
+			nnbr = nbr_index_search(db, i, e, db->new_nbrs);
+			if (nnbr > gr->cap - nedge)
+				break;
+
+			memcpy(gr->edge + nedge, db->new_nbrs, sizeof(pt_index_t) * nnbr);
+		}
+
+		nedge += nnbr;
+	}
+
+	gr->offset[i] = nedge;
+	gr->built = i;
+
+	return i;
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ * nbr_index.h
+ *
+ *  Created on: 2024-7-15
+ *      Author: xdu
+ */
+
+#ifndef NBR_INDEX_H_
+#define NBR_INDEX_H_
+
+#include "dbscan_prof.h"
+
+/*
+ * e领域搜索方式:
+ *     NBR_BRUTE_FORCE  逐点比较，O(n^2)，作为参考实现;
+ *     NBR_GRID         (aoa, pw)均匀网格，只访问相邻网格;
+ *     NBR_SORTED_SWEEP 按aoa排序，二分查找aoa窗口，只在窗口内比较.
+ * 网格与窗口按metric.h中各维的半径划分，计入freq时freq只参与距离比较.
+ */
+#define NBR_BRUTE_FORCE  1
+#define NBR_GRID         2
+#define NBR_SORTED_SWEEP 3
+
+#ifndef NBR_SEARCH_MEASURE
+#define NBR_SEARCH_MEASURE NBR_GRID
+#endif
+
+/*
+ * NBR_GRAPH为1时，dbscan()先把全部点的e领域按CSR格式(offset + edge)存下，
+ * 同一帧以相同的e再次聚类(如调整minpts)时不再搜索.
+ * 边数超过NBR_GRAPH_MAX_EDGES时，之后的点退回按需搜索.
+ */
+#ifndef NBR_GRAPH
+#define NBR_GRAPH 0
+#endif
+
+#ifndef NBR_GRAPH_MAX_EDGES
+#define NBR_GRAPH_MAX_EDGES (1 << 18)
+#endif
+
+/*
+ * 点序号的位宽，用于e领域结果、CSR边表、排序后的点序号和待扩展队列.
+ * 为16时每帧最多65535个点，DBSCAN_COMPACT(见dbscan.h)为1时默认为16.
+ */
+#ifndef DBSCAN_INDEX_BITS
+#if defined(DBSCAN_COMPACT) && DBSCAN_COMPACT
+#define DBSCAN_INDEX_BITS 16
+#else
+#define DBSCAN_INDEX_BITS 32
+#endif
+#endif
+
+#if DBSCAN_INDEX_BITS == 16
+typedef unsigned short pt_index_t;
+#define PT_INDEX_MAX (0xFFFF)
+#elif DBSCAN_INDEX_BITS == 32
+typedef int pt_index_t;
+#define PT_INDEX_MAX (0x7FFFFFFF)
+#else
+#error "DBSCAN_INDEX_BITS must be 16 or 32"
+#endif
+
+struct dbscan;
+
+struct nbr_index {
+	unsigned int e;				/* 建立索引时使用的e */
+
+#if NBR_SEARCH_MEASURE == NBR_GRID
+	pt_index_t *perm;			/* 按网格编号排序后的点序号 */
+	unsigned long long *key;	/* 非空网格的编号, (列 << 32) | 行 */
+	int *start;					/* 第c个网格的点在perm中的起始位置 */
+	int ncell;					/* 非空网格的数量 */
+	unsigned int width_aoa;		/* 网格边长，取e领域在该维上的半径 */
+	unsigned int width_pw;
+	unsigned int aoa_min;
+	unsigned int pw_min;
+#endif
+
+#if NBR_SEARCH_MEASURE == NBR_SORTED_SWEEP
+	pt_index_t *perm;			/* 按aoa升序排列的点序号 */
+#endif
+};
+
+#if NBR_GRAPH
+struct nbr_graph {
+	int *offset;				/* 第i个点的e领域为edge[offset[i], offset[i + 1]) */
+	pt_index_t *edge;
+	unsigned int cap;			/* edge的容量 */
+	int built;					/* 已存下e领域的点数，之后的点按需搜索 */
+	int valid;					/* 为0时需重新建立 */
+	unsigned int e;
+};
+#endif
+
+int nbr_index_build(struct dbscan *db, unsigned int e);
+
+int nbr_index_search(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs);
+
+#if DBSCAN_PROF
+/* 同nbr_index_search()，距离计算次数加到*ndist而不是db->prof，多个线程各用各的计数 */
+int nbr_index_search_count(struct dbscan *db, int point, unsigned int e, pt_index_t *nbrs,
+		unsigned long long *ndist);
+#endif
+
+#if NBR_GRAPH
+int nbr_graph_build(struct dbscan *db, unsigned int e);
+#endif
+
+#endif /* NBR_INDEX_H_ */
@@ -0,0 +1,197 @@
+/*
+ * nbr_kernel.c
+ *
+ *  Created on: 2024-7-22
+ *      Author: xdu
+ */
+
+#include "nbr_kernel.h"
+
+/* 平方和需要64位乘法，只对L1与L∞向量化 */
+#if METRIC_MEASURE != METRIC_L2SQ
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NBR_KERNEL_AVX2 1
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define NBR_KERNEL_SSE4 1
+#endif
+#endif
+
+#if defined(NBR_KERNEL_AVX2) || defined(NBR_KERNEL_SSE4)
+/* 把掩码中为1的位对应的序号写入nbrs */
+static inline int compress(unsigned int m, int base, pt_index_t *nbrs, int nnbr)
+{
+	while (m) {
+		nbrs[nnbr] = base + __builtin_ctz(m);
+		++nnbr;
+		m &= m - 1;
+	}
+
+	return nnbr;
+}
+#endif
+
+static inline int scalar_tail(const unsigned int *aoa, const unsigned int *freq,
+		const unsigned int *pw, int j, int n, unsigned int qa, unsigned int qf,
+		unsigned int qp, unsigned int e, pt_index_t *nbrs, int nnbr)
+{
+	for (; j < n; ++j) {
+		/* 无分支写入，不命中时下一次覆盖 */
+		nbrs[nnbr] = j;
+		nnbr += metric_within(qa, METRIC_FREQ ? qf : 0, qp,
+				aoa[j], METRIC_FREQ ? freq[j] : 0, pw[j], e);
+	}
+
+	return nnbr;
+}
+
+#if defined(NBR_KERNEL_AVX2)
+static inline __m256i absdiff(__m256i a, __m256i b)
+{
+	return _mm256_sub_epi32(_mm256_max_epu32(a, b), _mm256_min_epu32(a, b));
+}
+
+/* w为编译时常数，为1时不做乘法 */
+static inline __m256i weigh(__m256i d, unsigned int w)
+{
+	return w == 1 ? d : _mm256_mullo_epi32(d, _mm256_set1_epi32((int)w));
+}
+
+/* L1为各维之和，L∞为各维的最大值 */
+static inline __m256i combine(__m256i a, __m256i b)
+{
+#if METRIC_MEASURE == METRIC_L1
+	return _mm256_add_epi32(a, b);
+#else
+	return _mm256_max_epu32(a, b);
+#endif
+}
+
+static inline __m256i dist_le(const unsigned int *aoa, const unsigned int *freq,
+		const unsigned int *pw, __m256i va, __m256i vf, __m256i vp, __m256i ve)
+{
+	__m256i da = absdiff(va, _mm256_loadu_si256((const __m256i *)aoa));
+	__m256i dp = absdiff(vp, _mm256_loadu_si256((const __m256i *)pw));
+	__m256i d;
+
+#if METRIC_AOA_PERIOD
+	da = _mm256_min_epu32(da, _mm256_sub_epi32(
+			_mm256_set1_epi32((int)METRIC_AOA_PERIOD), da));
+#endif
+
+	d = combine(weigh(da, METRIC_W_AOA), weigh(dp, METRIC_W_PW));
+
+#if METRIC_FREQ
+	d = combine(d, weigh(absdiff(vf, _mm256_loadu_si256((const __m256i *)freq)),
+			METRIC_W_FREQ));
+#else
+	(void)freq;
+	(void)vf;
+#endif
+
+	/* 无符号比较d <= e，等价于min(d, e) == d */
+	return _mm256_cmpeq_epi32(_mm256_min_epu32(d, ve), d);
+}
+
+int nbr_kernel(const unsigned int *aoa, const unsigned int *freq, const unsigned int *pw,
+		int n, unsigned int qa, unsigned int qf, unsigned int qp, unsigned int e,
+		pt_index_t *nbrs)
+{
+	__m256i va = _mm256_set1_epi32((int)qa);
+	__m256i vf = _mm256_set1_epi32((int)qf);
+	__m256i vp = _mm256_set1_epi32((int)qp);
+	__m256i ve = _mm256_set1_epi32((int)e);
+	unsigned int m;
+	int j = 0;
+	int nnbr = 0;
+
+	for (; j + 16 <= n; j += 16) {
+		m = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(
+				dist_le(aoa + j, freq + j, pw + j, va, vf, vp, ve)));
+		m |= (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(
+				dist_le(aoa + j + 8, freq + j + 8, pw + j + 8, va, vf, vp, ve))) << 8;
+
+		nnbr = compress(m, j, nbrs, nnbr);
+	}
+
+	return scalar_tail(aoa, freq, pw, j, n, qa, qf, qp, e, nbrs, nnbr);
+}
+
+#elif defined(NBR_KERNEL_SSE4)
+static inline __m128i absdiff(__m128i a, __m128i b)
+{
+	return _mm_sub_epi32(_mm_max_epu32(a, b), _mm_min_epu32(a, b));
+}
+
+static inline __m128i weigh(__m128i d, unsigned int w)
+{
+	return w == 1 ? d : _mm_mullo_epi32(d, _mm_set1_epi32((int)w));
+}
+
+static inline __m128i combine(__m128i a, __m128i b)
+{
+#if METRIC_MEASURE == METRIC_L1
+	return _mm_add_epi32(a, b);
+#else
+	return _mm_max_epu32(a, b);
+#endif
+}
+
+static inline unsigned int dist_le(const unsigned int *aoa, const unsigned int *freq,
+		const unsigned int *pw, __m128i va, __m128i vf, __m128i vp, __m128i ve)
+{
+	__m128i da = absdiff(va, _mm_loadu_si128((const __m128i *)aoa));
+	__m128i dp = absdiff(vp, _mm_loadu_si128((const __m128i *)pw));
+	__m128i d;
+
+#if METRIC_AOA_PERIOD
+	da = _mm_min_epu32(da, _mm_sub_epi32(_mm_set1_epi32((int)METRIC_AOA_PERIOD), da));
+#endif
+
+	d = combine(weigh(da, METRIC_W_AOA), weigh(dp, METRIC_W_PW));
+
+#if METRIC_FREQ
+	d = combine(d, weigh(absdiff(vf, _mm_loadu_si128((const __m128i *)freq)),
+			METRIC_W_FREQ));
+#else
+	(void)freq;
+	(void)vf;
+#endif
+
+	return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(
+			_mm_cmpeq_epi32(_mm_min_epu32(d, ve), d)));
+}
+
+int nbr_kernel(const unsigned int *aoa, const unsigned int *freq, const unsigned int *pw,
+		int n, unsigned int qa, unsigned int qf, unsigned int qp, unsigned int e,
+		pt_index_t *nbrs)
+{
+	__m128i va = _mm_set1_epi32((int)qa);
+	__m128i vf = _mm_set1_epi32((int)qf);
+	__m128i vp = _mm_set1_epi32((int)qp);
+	__m128i ve = _mm_set1_epi32((int)e);
+	unsigned int m;
+	int j = 0;
+	int nnbr = 0;
+	int k;
+
+	for (; j + 16 <= n; j += 16) {
+		m = 0;
+		for (k = 0; k < 16; k += 4)
+			m |= dist_le(aoa + j + k, freq + j + k, pw + j + k, va, vf, vp, ve) << k;
+
+		nnbr = compress(m, j, nbrs, nnbr);
+	}
+
+	return scalar_tail(aoa, freq, pw, j, n, qa, qf, qp, e, nbrs, nnbr);
+}
+
+#else
+int nbr_kernel(const unsigned int *aoa, const unsigned int *freq, const unsigned int *pw,
+		int n, unsigned int qa, unsigned int qf, unsigned int qp, unsigned int e,
+		pt_index_t *nbrs)
+{
+	return scalar_tail(aoa, freq, pw, 0, n, qa, qf, qp, e, nbrs, 0);
+}
+#endif
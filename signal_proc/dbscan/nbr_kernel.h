@@ -0,0 +1,24 @@
+/*
+ * nbr_kernel.h
+ *
+ *  Created on: 2024-7-22
+ *      Author: xdu
+ */
+
+#ifndef NBR_KERNEL_H_
+#define NBR_KERNEL_H_
+
+#include "nbr_index.h"
+#include "metric.h"
+
+/*
+ * 计算(qa, qf, qp)到aoa/freq/pw[0..n)中每个点的距离(见metric.h)，
+ * 距离不大于e的点的序号依次写入nbrs，返回写入的个数.
+ * 距离为L1或L∞时，x86上按编译选项使用AVX2(一次16个点)或SSE4.1(一次16个点)，
+ * 否则为标量实现. METRIC_FREQ为0时不访问freq.
+ */
+int nbr_kernel(const unsigned int *aoa, const unsigned int *freq, const unsigned int *pw,
+		int n, unsigned int qa, unsigned int qf, unsigned int qp, unsigned int e,
+		pt_index_t *nbrs);
+
+#endif /* NBR_KERNEL_H_ */
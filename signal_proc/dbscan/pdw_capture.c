@@ -0,0 +1,175 @@
+/*
+ * pdw_capture.c
+ *
+ *  Created on: 2024-9-12
+ *      Author: xdu
+ */
+
+#include "pdw_capture.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CONVERT_CHUNK (256)		/* 追加时每次转换的点数 */
+
+int pdw_capture_open(struct pdw_capture *cap, const char *path)
+{
+	const struct pdw_cap_header *hdr;
+	struct stat st;
+	void *base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("capture: can't open %s.\n", path);
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct pdw_cap_header)) {
+		printf("capture: %s is too short.\n", path);
+		close(fd);
+		return -2;
+	}
+
+	/* 私有映射，写入只产生本进程的副本; 映射建立后可以关闭文件 */
+	base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		printf("capture: mmap %s failed.\n", path);
+		return -3;
+	}
+
+	hdr = (const struct pdw_cap_header *)base;
+	if (hdr->magic != PDW_CAP_MAGIC || hdr->version != PDW_CAP_VERSION
+			|| hdr->record_size != sizeof(pdw_st)) {
+		printf("capture: %s is not a version %d capture.\n", path, PDW_CAP_VERSION);
+		munmap(base, st.st_size);
+		return -4;
+	}
+
+	/* 一般顺序读取，让内核提前读入 */
+	madvise(base, st.st_size, MADV_SEQUENTIAL);
+
+	cap->base = (char *)base;
+	cap->size = st.st_size;
+	cap->hdr = hdr;
+
+	return 0;
+}
+
+int pdw_capture_next(const struct pdw_capture *cap, size_t *pos,
+		const struct pdw_cap_frame **frame, pdw_st **set)
+{
+	const struct pdw_cap_frame *f;
+	size_t left;
+
+	if (*pos >= cap->size)
+		return 0;
+
+	left = cap->size - *pos;
+	f = (const struct pdw_cap_frame *)(cap->base + *pos);
+	if (left < sizeof(*f) || f->npdw > (left - sizeof(*f)) / sizeof(pdw_st)) {
+		printf("capture: frame at %zu is truncated.\n", *pos);
+		return -1;
+	}
+
+	*frame = f;
+	*set = (pdw_st *)(f + 1);
+	*pos += pdw_cap_frame_bytes(f->npdw);
+
+	return 1;
+}
+
+void pdw_capture_close(struct pdw_capture *cap)
+{
+	if (cap->base)
+		munmap(cap->base, cap->size);
+	cap->base = NULL;
+	cap->size = 0;
+	cap->hdr = NULL;
+}
+
+int pdw_capture_create(struct pdw_cap_writer *w, const char *path)
+{
+	w->fp = fopen(path, "wb");
+	if (!w->fp) {
+		printf("capture: can't create %s.\n", path);
+		return -1;
+	}
+
+	memset(&w->hdr, 0, sizeof(w->hdr));
+	w->hdr.magic = PDW_CAP_MAGIC;
+	w->hdr.version = PDW_CAP_VERSION;
+	w->hdr.record_size = sizeof(pdw_st);
+
+	if (fwrite(&w->hdr, sizeof(w->hdr), 1, w->fp) != 1) {
+		printf("capture: write %s failed.\n", path);
+		fclose(w->fp);
+		w->fp = NULL;
+		return -2;
+	}
+
+	return 0;
+}
+
+int pdw_capture_append(struct pdw_cap_writer *w, const ORIG_PDW *src, unsigned int npdw,
+		unsigned long long time)
+{
+	static const char zero[8];
+	struct pdw_cap_frame f;
+	pdw_st buf[CONVERT_CHUNK];
+	unsigned int i, k, n;
+	size_t pad;
+
+	f.npdw = npdw;
+	f.seq = (unsigned int)w->hdr.nframe;
+	f.time = time;
+	if (fwrite(&f, sizeof(f), 1, w->fp) != 1)
+		return -1;
+
+	/* ORIG_PDW的布局与pdw_st不同，分块转换后写入 */
+	for (i = 0; i < npdw; i += n) {
+		n = npdw - i < CONVERT_CHUNK ? npdw - i : CONVERT_CHUNK;
+		for (k = 0; k < n; ++k) {
+			buf[k].aoa = src[i + k].AOA;
+			buf[k].freq = src[i + k].FC;
+			buf[k].pw = src[i + k].PW;
+		}
+
+		if (fwrite(buf, sizeof(buf[0]), n, w->fp) != n)
+			return -1;
+	}
+
+	pad = pdw_cap_frame_bytes(npdw) - sizeof(f) - sizeof(pdw_st) * (size_t)npdw;
+	if (pad && fwrite(zero, 1, pad, w->fp) != pad)
+		return -1;
+
+	++w->hdr.nframe;
+	w->hdr.npdw += npdw;
+	if (npdw > w->hdr.max_npdw)
+		w->hdr.max_npdw = npdw;
+
+	return 0;
+}
+
+int pdw_capture_finish(struct pdw_cap_writer *w)
+{
+	int ret = 0;
+
+	if (!w->fp)
+		return -1;
+
+	if (fseek(w->fp, 0, SEEK_SET) != 0
+			|| fwrite(&w->hdr, sizeof(w->hdr), 1, w->fp) != 1) {
+		printf("capture: write header failed.\n");
+		ret = -2;
+	}
+
+	if (fclose(w->fp) != 0)
+		ret = -2;
+	w->fp = NULL;
+
+	return ret;
+}
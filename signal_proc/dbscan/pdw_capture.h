@@ -0,0 +1,86 @@
+/*
+ * pdw_capture.h
+ *
+ *  Created on: 2024-9-12
+ *      Author: xdu
+ */
+
+#ifndef PDW_CAPTURE_H_
+#define PDW_CAPTURE_H_
+
+#include "dbscan.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * PDW采集文件，按本机字节序存放:
+ *     struct pdw_cap_header                     文件头;
+ *     每帧 struct pdw_cap_frame + npdw个pdw_st  帧头之后是该帧的点，整帧补齐到8字节.
+ * pdw_st为12字节，与PDW_AOS的工作存储相同，映射后可直接交给attach_data()，不拷贝.
+ * 读写均只用于主机(POSIX mmap)，DSP上不编译本文件.
+ */
+#define PDW_CAP_MAGIC   (0x43574450u)	/* "PDWC" */
+#define PDW_CAP_VERSION (1)
+
+struct pdw_cap_header {
+	unsigned int magic;
+	unsigned int version;
+	unsigned int record_size;	/* sizeof(pdw_st)，读取时校验 */
+	unsigned int max_npdw;		/* 最长一帧的点数，用于init_dbscan() */
+	unsigned long long nframe;
+	unsigned long long npdw;	/* 全部帧的点数之和 */
+};
+
+struct pdw_cap_frame {
+	unsigned int npdw;
+	unsigned int seq;			/* 帧号，从0开始 */
+	unsigned long long time;	/* 时间戳，单位由采集端决定 */
+};
+
+/* 一帧在文件中占的字节数 */
+static inline size_t pdw_cap_frame_bytes(unsigned int npdw)
+{
+	return (sizeof(struct pdw_cap_frame) + sizeof(pdw_st) * (size_t)npdw + 7) & ~(size_t)7;
+}
+
+/* 读: 映射整个文件，可由多个线程各自持有读位置 */
+struct pdw_capture {
+	char *base;
+	size_t size;
+	const struct pdw_cap_header *hdr;
+};
+
+int pdw_capture_open(struct pdw_capture *cap, const char *path);
+
+/* 第一帧的读位置 */
+static inline size_t pdw_capture_begin(const struct pdw_capture *cap)
+{
+	(void)cap;
+
+	return sizeof(struct pdw_cap_header);
+}
+
+/*
+ * 读取*pos处的一帧并把*pos移到下一帧，返回1; 文件结束返回0，格式错误返回负数.
+ * *set指向映射中的点，映射为私有的可写映射，dbscan_dedup()改写时不影响文件.
+ */
+int pdw_capture_next(const struct pdw_capture *cap, size_t *pos,
+		const struct pdw_cap_frame **frame, pdw_st **set);
+
+void pdw_capture_close(struct pdw_capture *cap);
+
+/* 写: 先写文件头占位，逐帧追加，pdw_capture_finish()时回写文件头 */
+struct pdw_cap_writer {
+	FILE *fp;
+	struct pdw_cap_header hdr;
+};
+
+int pdw_capture_create(struct pdw_cap_writer *w, const char *path);
+
+/* 追加一帧，src为接收到的原始PDW */
+int pdw_capture_append(struct pdw_cap_writer *w, const ORIG_PDW *src, unsigned int npdw,
+		unsigned long long time);
+
+int pdw_capture_finish(struct pdw_cap_writer *w);
+
+#endif /* PDW_CAPTURE_H_ */
@@ -0,0 +1,146 @@
+/*
+ * lf_stack.c
+ *
+ *  Created on: 2024-10-14
+ *      Author: xdu
+ */
+
+#include "lf_stack.h"
+#include <stdio.h>
+
+#define TAG_ONE  (1ull << LF_INDEX_BITS)
+#define TAG_MASK (~(unsigned long long)LF_INDEX_MASK)
+
+/* 申请了LF_STACK_NUM个栈，每个栈有LF_STACK_MAX_NUM个节点 */
+#pragma DATA_SECTION(lf_buffer, ".static_var")
+static struct lf_node lf_buffer[LF_STACK_NUM][LF_STACK_MAX_NUM];
+static pool_word_t lf_map[POOL_WORDS(LF_STACK_NUM)];
+static struct pool lf_pool = POOL_INIT(lf_buffer, lf_map, LF_STACK_NUM, sizeof(lf_buffer[0]));
+
+/* 把first..last这一串节点压入list，last->next由本函数设置 */
+static void push_chain(struct lf_stack *st, atomic_ullong *list, unsigned int first, unsigned int last)
+{
+	unsigned long long old = atomic_load_explicit(list, memory_order_relaxed);
+
+	do {
+		atomic_store_explicit(&st->node[last].next, (unsigned int)(old & LF_INDEX_MASK),
+				memory_order_relaxed);
+	} while (!atomic_compare_exchange_weak_explicit(list, &old,
+			((old & TAG_MASK) + TAG_ONE) | first,
+			memory_order_release, memory_order_relaxed));
+}
+
+/* 弹出list头部的节点，返回下标，链表为空时返回LF_NIL */
+static unsigned int pop_node(struct lf_stack *st, atomic_ullong *list)
+{
+	unsigned long long old = atomic_load_explicit(list, memory_order_acquire);
+	unsigned int i, next;
+
+	do {
+		i = (unsigned int)(old & LF_INDEX_MASK);
+		if (i == LF_NIL)
+			return LF_NIL;
+
+		/* 节点可能已被其他线程弹出并改写，此时标记已变，CAS会失败 */
+		next = atomic_load_explicit(&st->node[i].next, memory_order_relaxed);
+	} while (!atomic_compare_exchange_weak_explicit(list, &old,
+			((old & TAG_MASK) + TAG_ONE) | next,
+			memory_order_acquire, memory_order_acquire));
+
+	return i;
+}
+
+int lf_stack_init(struct lf_stack *st)
+{
+	unsigned int i;
+
+	st->node = (struct lf_node *)pool_alloc(&lf_pool);
+	if (!st->node) {
+		printf("init: lf stack buffer is full.\n");
+		return -1;
+	}
+
+	/* 所有节点连成空闲链表 */
+	for (i = 0; i < LF_STACK_MAX_NUM; ++i)
+		atomic_init(&st->node[i].next, i + 1 < LF_STACK_MAX_NUM ? i + 1 : LF_NIL);
+
+	atomic_init(&st->head, LF_NIL);
+	atomic_init(&st->free, 0);
+
+	return 0;
+}
+
+int lf_stack_push(struct lf_stack *st, ST_data_type dat)
+{
+	unsigned int i = pop_node(st, &st->free);
+
+	if (i == LF_NIL) {
+		printf("push: lf stack buffer is full.\n");
+		return -1;
+	}
+
+	st->node[i].val = dat;
+	push_chain(st, &st->head, i, i);
+
+	return 0;
+}
+
+int lf_stack_push_n(struct lf_stack *st, const ST_data_type *src, int n)
+{
+	unsigned int first = LF_NIL, last = LF_NIL, i;
+	int k;
+
+	if (n <= 0)
+		return 0;
+
+	/* 新节点接在串的前面，src[n - 1]在最前 */
+	for (k = 0; k < n; ++k) {
+		i = pop_node(st, &st->free);
+		if (i == LF_NIL) {
+			/* 节点不够，已取出的节点还回去 */
+			if (first != LF_NIL)
+				push_chain(st, &st->free, first, last);
+			printf("push_n: lf stack buffer is full.\n");
+			return -1;
+		}
+
+		st->node[i].val = src[k];
+		atomic_store_explicit(&st->node[i].next, first, memory_order_relaxed);
+		if (first == LF_NIL)
+			last = i;
+		first = i;
+	}
+
+	push_chain(st, &st->head, first, last);
+
+	return 0;
+}
+
+int lf_stack_pop(struct lf_stack *st, ST_data_type *to)
+{
+	unsigned int i = pop_node(st, &st->head);
+
+	if (i == LF_NIL)
+		return -1;
+
+	*to = st->node[i].val;
+	push_chain(st, &st->free, i, i);
+
+	return 0;
+}
+
+void lf_stack_destroy(struct lf_stack *st)
+{
+	if (!st || !st->node) {
+		printf("destroy: lf stack is not initialized.\n");
+		return;
+	}
+
+	pool_free(&lf_pool, st->node);
+	st->node = NULL;
+}
+
+void lf_stack_pool_stats(struct pool_stats *s)
+{
+	pool_get_stats(&lf_pool, s);
+}
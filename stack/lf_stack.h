@@ -0,0 +1,69 @@
+/*
+ * lf_stack.h
+ *
+ *  Created on: 2024-10-14
+ *      Author: xdu
+ */
+
+#ifndef LF_STACK_H_
+#define LF_STACK_H_
+
+#include "stack.h"
+#include "pool.h"
+#include <stdatomic.h>
+
+#define LF_CACHE_LINE (64)
+
+#ifndef LF_STACK_NUM
+#define LF_STACK_NUM (8)			/* 栈的个数 */
+#endif
+#ifndef LF_STACK_MAX_NUM
+#define LF_STACK_MAX_NUM (4096)		/* 每个栈的节点个数，小于LF_NIL */
+#endif
+
+/*
+ * 无锁栈(Treiber)，多个线程可以同时push、pop.
+ * 节点来自固定的节点池，用下标代替指针; 栈顶与空闲节点链表的头都是64位的(标记 << 32) | 下标，
+ * 每次修改标记加一，节点被弹出又压回时CAS能发现头已变化(ABA). 32位的标记要回绕2^32次
+ * 才会重复，一个线程在读头与CAS之间被挂起的时间内不会发生.
+ * 头的CAS是64位的: ATOMIC_LLONG_LOCK_FREE不为2的目标(如部分32位处理器)上，
+ * atomic_ullong由编译器的运行库加锁实现，结果仍然正确，但不再是无锁的，
+ * 这时LF_STACK_LOCK_FREE为0.
+ */
+#define LF_INDEX_BITS (32)
+#define LF_INDEX_MASK (0xFFFFFFFFu)
+#define LF_NIL LF_INDEX_MASK		/* 空链表 */
+#define LF_STACK_LOCK_FREE (ATOMIC_LLONG_LOCK_FREE == 2)
+
+#if LF_STACK_MAX_NUM >= LF_NIL
+#error "LF_STACK_MAX_NUM must be less than LF_NIL"
+#endif
+
+struct lf_node {
+	atomic_uint next;
+	ST_data_type val;
+};
+
+struct lf_stack {
+	_Alignas(LF_CACHE_LINE) atomic_ullong head;	/* 栈顶 */
+	_Alignas(LF_CACHE_LINE) atomic_ullong free;	/* 空闲节点 */
+	_Alignas(LF_CACHE_LINE) struct lf_node *node;
+};
+
+int lf_stack_init(struct lf_stack *st);
+
+/* 节点用完时返回-1 */
+int lf_stack_push(struct lf_stack *st, ST_data_type dat);
+
+/* 在本线程内先把n个元素链成一串，再用一次CAS整串压入，最后一个元素在栈顶 */
+int lf_stack_push_n(struct lf_stack *st, const ST_data_type *src, int n);
+
+/* 栈空时返回-1 */
+int lf_stack_pop(struct lf_stack *st, ST_data_type *to);
+
+void lf_stack_destroy(struct lf_stack *st);
+
+/* 静态缓冲区的占用情况 */
+void lf_stack_pool_stats(struct pool_stats *s);
+
+#endif /* LF_STACK_H_ */
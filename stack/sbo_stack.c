@@ -0,0 +1,82 @@
+/*
+ * sbo_stack.c
+ *
+ *  Created on: 2024-9-23
+ *      Author: xdu
+ */
+
+#include "sbo_stack.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ARENA_ALIGN (8)
+
+void stack_arena_init(struct stack_arena *a, void *buf, unsigned int size)
+{
+	a->base = (char *)buf;
+	a->size = size;
+	a->used = 0;
+}
+
+/* 从arena中取bytes字节，按ARENA_ALIGN对齐 */
+static void *arena_alloc(struct stack_arena *a, unsigned int bytes)
+{
+	unsigned int off = (a->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+	if (off > a->size || bytes > a->size - off)
+		return NULL;
+
+	a->used = off + bytes;
+
+	return a->base + off;
+}
+
+int sbo_stack_init(struct sbo_stack *st, struct stack_arena *arena)
+{
+	if (!st) {
+		printf("init: stack not exist.\n");
+		return -1;
+	}
+
+	st->capacity = 0;
+	st->spill_size = 0;
+	st->spill = NULL;
+	st->arena = arena;
+
+	return 0;
+}
+
+int sbo_stack_grow_push(struct sbo_stack *st, ST_data_type dat)
+{
+	struct stack_arena *a = st->arena;
+	unsigned int size = st->spill_size ? st->spill_size * 2 : SBO_SPILL_MIN;
+	unsigned int extra = (size - st->spill_size) * sizeof(ST_data_type);
+	char *end = (char *)(st->spill + st->spill_size);
+	ST_data_type *spill;
+
+	if (!a) {
+		printf("push: stack buffer is full.\n");
+		return -1;
+	}
+
+	if (st->spill && end == a->base + a->used && extra <= a->size - a->used) {
+		/* 溢出区在arena末尾，原地扩展 */
+		a->used += extra;
+	} else {
+		spill = (ST_data_type *)arena_alloc(a, size * sizeof(ST_data_type));
+		if (!spill) {
+			printf("push: stack arena is full.\n");
+			return -1;
+		}
+
+		if (st->spill_size)
+			memcpy(spill, st->spill, sizeof(ST_data_type) * st->spill_size);
+		st->spill = spill;
+	}
+
+	st->spill_size = size;
+	st->spill[st->capacity - SBO_STACK_INLINE] = dat;
+	++st->capacity;
+
+	return 0;
+}
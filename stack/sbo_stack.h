@@ -0,0 +1,98 @@
+/*
+ * sbo_stack.h
+ *
+ *  Created on: 2024-9-23
+ *      Author: xdu
+ */
+
+#ifndef SBO_STACK_H_
+#define SBO_STACK_H_
+
+#include "stack.h"
+#include <stdbool.h>
+
+/*
+ * 小栈优化: 前SBO_STACK_INLINE个元素存放在结构体内，
+ * 超出时才从调用者提供的arena中申请溢出区，不占用静态槽池，也不访问堆.
+ * 溢出区满时加倍: 溢出区恰好位于arena末尾则原地扩展，否则申请新区并复制.
+ * arena只能整体重置，重置后使用它的栈都需要重新初始化.
+ */
+#ifndef SBO_STACK_INLINE
+#define SBO_STACK_INLINE (32)
+#endif
+
+#define SBO_SPILL_MIN (64)		/* 溢出区的初始元素个数 */
+
+struct stack_arena {
+	char *base;
+	unsigned int size;
+	unsigned int used;
+};
+
+struct sbo_stack {
+	unsigned int capacity;		/* 栈中元素的数量 */
+	unsigned int spill_size;	/* 溢出区可存放的元素个数 */
+	ST_data_type *spill;
+	struct stack_arena *arena;	/* 为NULL时不能溢出 */
+	ST_data_type local[SBO_STACK_INLINE];
+};
+
+void stack_arena_init(struct stack_arena *a, void *buf, unsigned int size);
+
+static inline void stack_arena_reset(struct stack_arena *a)
+{
+	a->used = 0;
+}
+
+int sbo_stack_init(struct sbo_stack *st, struct stack_arena *arena);
+
+/* 溢出区已满时的慢路径 */
+int sbo_stack_grow_push(struct sbo_stack *st, ST_data_type dat);
+
+static inline int sbo_stack_push(struct sbo_stack *st, ST_data_type dat)
+{
+	unsigned int k = st->capacity - SBO_STACK_INLINE;
+
+	if (st->capacity < SBO_STACK_INLINE)
+		st->local[st->capacity] = dat;
+	else if (k < st->spill_size)
+		st->spill[k] = dat;
+	else
+		return sbo_stack_grow_push(st, dat);
+
+	++st->capacity;
+
+	return 0;
+}
+
+static inline int sbo_stack_pop(struct sbo_stack *st, ST_data_type *to)
+{
+	if (st->capacity == 0)
+		return -1;
+
+	--st->capacity;
+	if (st->capacity < SBO_STACK_INLINE)
+		*to = st->local[st->capacity];
+	else
+		*to = st->spill[st->capacity - SBO_STACK_INLINE];
+
+	return 0;
+}
+
+static inline bool sbo_stack_empty(struct sbo_stack *st)
+{
+	return st->capacity == 0;
+}
+
+static inline unsigned int sbo_stack_size(struct sbo_stack *st)
+{
+	return st->capacity;
+}
+
+/* 溢出区保留，下次溢出时直接使用 */
+static inline void sbo_stack_clear(struct sbo_stack *st)
+{
+	st->capacity = 0;
+}
+
+#endif /* SBO_STACK_H_ */
@@ -14,32 +14,21 @@
 
 #if INIT_MEASURE == STATIC
 
-#define MAX_NUM (4096)
-#define STACK_NUM (8)
-static unsigned char buffer_map = 0;
+#define MAX_NUM STACK_MAX_NUM
 
-/* 申请了STACK_NUM个栈，每个栈最多有STACK_NUM元素 */
+/* 申请了STACK_NUM个栈，每个栈最多有MAX_NUM元素 */
 static st_data data_buffer[STACK_NUM][MAX_NUM];
+static pool_word_t data_map[POOL_WORDS(STACK_NUM)];
+static struct pool data_pool = POOL_INIT(data_buffer, data_map, STACK_NUM, sizeof(data_buffer[0]));
 
 int init(struct stack *st)
 {
-	int i;
-	int length = sizeof(buffer_map) * 8;
-
-	/* 寻找未被使用的栈，buffer_map的第i位是0，则表示第i个栈尚未被使用 */
-	for (i = 0; i < length; ++i) {
-		if (!(buffer_map & (1 << i)))
-			break;
-	}
-
-	if (i == length) {
+	st->top = (st_data *)pool_alloc(&data_pool);
+	if (!st->top) {
 		printf("init: stack buffer is full.\n");
 		return -1;
 	}
 
-	/* buffer_map的第i位置1，占用第i个栈 */
-	buffer_map |= (1 << i);
-	st->top = data_buffer[i];
 	st->capacity = 0;
 
 	return 0;
@@ -60,10 +49,8 @@ int push(struct stack *st, ST_data_type dat)
 
 int pop(struct stack *st, ST_data_type *to)
 {
-	if (st->capacity <= 0) {
-		printf("pop: stack buffer is empty.\n");
+	if (st->capacity <= 0)
 		return -1;
-	}
 
 	--st->capacity;
 	*to = st->top[st->capacity].val;
@@ -78,30 +65,54 @@ void clear(struct stack *st)
 
 void destroy(struct stack *st)
 {
-	int i;
-	int length = sizeof(buffer_map) * 8;
-
-	for (i = 0; i < length; ++i) {
-		if (st->top == data_buffer[i]) {
-			buffer_map &= ~(1 << i);
-		}
-	}
+	pool_free(&data_pool, st->top);
 
 	st->top = NULL;
 	st->capacity = 0;
 }
+
+void stack_pool_stats(struct pool_stats *s)
+{
+	pool_get_stats(&data_pool, s);
+}
 #endif
 
 #if INIT_MEASURE == DYNAMIC
-int init(stack *st)
+
+/* 取一个空块，优先使用备用块 */
+static struct stack_chunk *get_chunk(struct stack *st)
 {
-	st->top = (st_data *)malloc(sizeof(st_data));
-	if (st->top) {
+	struct stack_chunk *c = st->spare;
+
+	if (c) {
+		st->spare = NULL;
+		return c;
+	}
+
+	return (struct stack_chunk *)malloc(sizeof(struct stack_chunk));
+}
+
+/* 空出的块留作备用，已有备用块时释放 */
+static void put_chunk(struct stack *st, struct stack_chunk *c)
+{
+	if (st->spare)
+		free(c);
+	else
+		st->spare = c;
+}
+
+int init(struct stack *st)
+{
+	st->spare = NULL;
+	st->chunk = get_chunk(st);
+	if (!st->chunk) {
 		printf("init: malloc stack failed.\n");
 		return -1;
 	}
 
-	st->top->pre = NULL;
+	st->chunk->pre = NULL;
+	st->top = st->chunk->data;
+	st->n = 0;
 	st->capacity = 0;
 
 	return 0;
@@ -109,67 +120,81 @@ int init(stack *st)
 
 int push(struct stack *st, ST_data_type dat)
 {
-	st_data *pre;
-
-	st->top->val = dat;
-	++st->capacity;
+	struct stack_chunk *c;
+
+	/* 当前块已满，换到新的一块 */
+	if (st->n == STACK_CHUNK) {
+		c = get_chunk(st);
+		if (!c) {
+			printf("push: malloc stack failed.\n");
+			return -1;
+		}
 
-	pre = st->top;
-	st->top = (st_data *)malloc(sizeof(st_data));
-	if (st->top) {
-		printf("push: malloc stack failed.\n");
-		return -1;
+		c->pre = st->chunk;
+		st->chunk = c;
+		st->top = c->data;
+		st->n = 0;
 	}
-	st->top->pre = pre;
+
+	st->top[st->n++].val = dat;
+	++st->capacity;
 
 	return 0;
 }
 
 int pop(struct stack *st, ST_data_type *to)
 {
-	st_data *pre;
+	struct stack_chunk *c;
 
 	if (st->capacity == 0)
 		return -1;
 
-	pre = st->top->pre;
-	*to = pre->val;
-
-	free(st->top);
-	st->top = pre;
+	/* 当前块已空，回到下面已满的一块 */
+	if (st->n == 0) {
+		c = st->chunk;
+		st->chunk = c->pre;
+		st->top = st->chunk->data;
+		st->n = STACK_CHUNK;
+		put_chunk(st, c);
+	}
 
+	*to = st->top[--st->n].val;
 	--st->capacity;
 
 	return 0;
 }
 
+/* 只保留最下面的一块和备用块 */
 void clear(struct stack *st)
 {
-	st_data *p;
-
-	while (st->top->pre) {
-		p = st->top->pre;
-
-		free(st->top);
+	struct stack_chunk *c;
 
-		st->top = p;
+	while (st->chunk->pre) {
+		c = st->chunk;
+		st->chunk = c->pre;
+		put_chunk(st, c);
 	}
 
+	st->top = st->chunk->data;
+	st->n = 0;
 	st->capacity = 0;
 }
 
 void destroy(struct stack *st)
 {
-	st_data *p;
+	struct stack_chunk *c;
 
-	while (st->top) {
-		p = st->top->pre;
-
-		free(st->top);
-
-		st->top = p;
+	while (st->chunk) {
+		c = st->chunk->pre;
+		free(st->chunk);
+		st->chunk = c;
 	}
 
+	free(st->spare);
+
+	st->spare = NULL;
+	st->top = NULL;
+	st->n = 0;
 	st->capacity = 0;
 }
 #endif
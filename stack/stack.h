@@ -13,32 +13,71 @@
 #define STATIC 1
 #define DYNAMIC 2
 
+/*
+ * STATIC  从静态槽池的STACK_NUM个缓冲区中分配，每个栈最多STACK_MAX_NUM个元素;
+ * DYNAMIC 分块的栈，每块STACK_CHUNK个元素，块满时再申请一块，深度不受限制.
+ *         出栈空出的块留作备用，在块边界上反复压栈、出栈不会反复申请、释放.
+ */
+#ifndef INIT_MEASURE
 #define INIT_MEASURE STATIC
+#endif
+
+#if INIT_MEASURE == STATIC
+#include "pool.h"
+
+#ifndef STACK_NUM
+#define STACK_NUM (8)			/* 栈的个数 */
+#endif
+#ifndef STACK_MAX_NUM
+#define STACK_MAX_NUM (4096)	/* 每个栈的元素个数 */
+#endif
+#endif
+
+#if INIT_MEASURE == DYNAMIC
+#ifndef STACK_CHUNK
+#define STACK_CHUNK (256)		/* 每块的元素个数 */
+#endif
+#endif
 
 typedef int ST_data_type;
 
 typedef struct stack_data {
 	ST_data_type val;
+}st_data;
 
 #if INIT_MEASURE == DYNAMIC
-	struct stack_data *pre;
+struct stack_chunk {
+	struct stack_chunk *pre;	/* 下面的一块 */
+	st_data data[STACK_CHUNK];
+};
 #endif
-}st_data;
 
 struct stack {
 //	st_data *data;
-	st_data *top;
+	st_data *top;				/* 当前块(STATIC时为整个缓冲区)的起始地址 */
 	unsigned int capacity;
+
+#if INIT_MEASURE == DYNAMIC
+	struct stack_chunk *chunk;	/* 当前块 */
+	struct stack_chunk *spare;	/* 备用的空块 */
+	unsigned int n;				/* 当前块中的元素个数 */
+#endif
 };
 
 int stack_init(struct stack *st);
 
 int stack_push(struct stack *st, ST_data_type dat);
 
+/* 栈空时返回-1，不打印: 调用者常以出栈失败作为循环的结束 */
 int stack_pop(struct stack *st, ST_data_type *to);
 
 void stack_clear(struct stack *st);
 
 void destroy_stack(struct stack *st);
 
+#if INIT_MEASURE == STATIC
+/* 静态缓冲区的占用情况 */
+void stack_pool_stats(struct pool_stats *s);
+#endif
+
 #endif /* STACK_H_ */
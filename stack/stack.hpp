@@ -0,0 +1,95 @@
+/*
+ * stack.hpp
+ *
+ *  Created on: 2024-9-30
+ *      Author: xdu
+ */
+
+#ifndef STACK_HPP_
+#define STACK_HPP_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/*
+ * 与stack.c(STATIC模式)相同的数组栈，元素类型为模板参数.
+ * 存储在对象内，满时push返回false; 元素原地构造、析构，可以存放只能移动的类型.
+ * C接口(struct stack)保持不变，stack_int即对应的int实例.
+ */
+namespace ctl {
+
+template <class T, std::size_t N>
+class static_stack {
+	static_assert(N > 0, "static_stack: N must be positive");
+
+public:
+	typedef T value_type;
+	typedef std::size_t size_type;
+
+	static constexpr size_type capacity() { return N; }
+
+	static_stack() : count_(0) {}
+	~static_stack() { clear(); }
+
+	static_stack(const static_stack &) = delete;
+	static_stack &operator=(const static_stack &) = delete;
+
+	size_type size() const { return count_; }
+	bool empty() const { return count_ == 0; }
+	bool full() const { return count_ == N; }
+
+	T &top() { return data()[count_ - 1]; }
+	const T &top() const { return data()[count_ - 1]; }
+
+	template <class... Args>
+	bool emplace(Args &&...args)
+	{
+		if (count_ == N)
+			return false;
+
+		::new (static_cast<void *>(data() + count_)) T(std::forward<Args>(args)...);
+		++count_;
+		return true;
+	}
+
+	bool push(const T &v) { return emplace(v); }
+	bool push(T &&v) { return emplace(std::move(v)); }
+
+	/* 调用者须保证非空 */
+	void pop()
+	{
+		--count_;
+		data()[count_].~T();
+	}
+
+	bool try_pop(T &to)
+	{
+		if (count_ == 0)
+			return false;
+
+		to = std::move(top());
+		pop();
+		return true;
+	}
+
+	void clear()
+	{
+		while (count_)
+			pop();
+	}
+
+private:
+	T *data() { return reinterpret_cast<T *>(buf_); }
+	const T *data() const { return reinterpret_cast<const T *>(buf_); }
+
+	size_type count_;
+	alignas(T) unsigned char buf_[sizeof(T) * N];
+};
+
+/* 与C接口struct stack(STATIC模式)对应的int实例 */
+typedef static_stack<int, 4096> stack_int;
+
+} /* namespace ctl */
+
+#endif /* STACK_HPP_ */